@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+
+// Вращающиеся калиперы на выпуклых многоугольниках и ближайшая пара точек.
+// Все функции многоугольника работают за O(n) по выпуклому многоугольнику;
+// для невыпуклого сначала строится выпуклая оболочка вершин, результат от
+// этого не меняется.
+namespace my {
+// Выпуклая оболочка (Эндрю), O(n log n): против часовой стрелки, без
+// повторов и вершин на сторонах.
+template <typename T>
+std::vector<BasicPoint<T>> convex_hull(std::vector<BasicPoint<T>> points) {
+  std::sort(points.begin(), points.end(),
+            [](const BasicPoint<T>& a, const BasicPoint<T>& b) {
+              return a.x < b.x || (a.x == b.x && a.y < b.y);
+            });
+  points.erase(std::unique(points.begin(), points.end(),
+                           [](const BasicPoint<T>& a, const BasicPoint<T>& b) {
+                             return a.x == b.x && a.y == b.y;
+                           }),
+               points.end());
+  if (points.size() < 3) {
+    return points;
+  }
+
+  std::vector<BasicPoint<T>> hull(2 * points.size());
+  size_t size = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    while (size >= 2 &&
+           orient2d(hull[size - 2], hull[size - 1], points[i]) <= 0) {
+      --size;
+    }
+    hull[size++] = points[i];
+  }
+  for (size_t i = points.size() - 1, lower = size + 1; i-- > 0;) {
+    while (size >= lower &&
+           orient2d(hull[size - 2], hull[size - 1], points[i]) <= 0) {
+      --size;
+    }
+    hull[size++] = points[i];
+  }
+  hull.resize(size - 1);
+  return hull;
+}
+
+namespace detail {
+// Вершины выпуклого многоугольника против часовой стрелки без вершин на
+// сторонах; невыпуклый заменяется оболочкой.
+template <typename T>
+std::vector<BasicPoint<T>> convex_ccw(const BasicPolygon<T>& polygon) {
+  std::vector<BasicPoint<T>> points = polygon.getVertices();
+  // isConvex берёт три вершины по модулю их числа
+  if (points.size() < 3 || !polygon.isConvex()) {
+    return convex_hull(std::move(points));
+  }
+
+  double twice_area = 0;
+  for (size_t i = 0, prev = points.size() - 1; i < points.size(); prev = i++) {
+    twice_area += double(points[prev].x) * points[i].y -
+                  double(points[i].x) * points[prev].y;
+  }
+  if (twice_area < 0) {
+    std::reverse(points.begin(), points.end());
+  }
+
+  std::vector<BasicPoint<T>> ans;
+  ans.reserve(points.size());
+  size_t n = points.size();
+  for (size_t i = 0, prev = n - 1; i < n; prev = i++) {
+    if (orient2d(points[prev], points[i], points[(i + 1) % n]) != 0) {
+      ans.push_back(points[i]);
+    }
+  }
+  // все вершины на одной прямой
+  return ans.size() < 3 ? convex_hull(std::move(points)) : ans;
+}
+
+template <typename T>
+using real_of = typename scalar_traits<T>::real_type;
+
+template <typename T>
+real_of<T> cross(const BasicPoint<T>& o, const BasicPoint<T>& a,
+                 const BasicPoint<T>& b) {
+  using real = real_of<T>;
+  return (real(a.x) - o.x) * (real(b.y) - o.y) -
+         (real(a.y) - o.y) * (real(b.x) - o.x);
+}
+
+// Для каждого ребра (i, i + 1) - самая далёкая от него вершина j.
+// Указатель j только идёт вперёд, поэтому обход занимает O(n).
+template <typename T, typename Func>
+void for_each_antipodal(const std::vector<BasicPoint<T>>& hull, Func func) {
+  size_t n = hull.size();
+  size_t j = 1;
+  for (size_t i = 0; i < n; ++i) {
+    size_t next = (i + 1) % n;
+    while (cross(hull[i], hull[next], hull[(j + 1) % n]) >
+           cross(hull[i], hull[next], hull[j])) {
+      j = (j + 1) % n;
+    }
+    func(i, next, j);
+  }
+}
+
+// Лучший по cost(ширина, высота) описанный прямоугольник. Одна из сторон
+// оптимального лежит на стороне многоугольника (Фримен - Шапира), так что
+// достаточно перебрать стороны, двигая три калипера: дальний по ребру,
+// дальний от ребра и ближний по ребру.
+template <typename T, typename Cost>
+BasicRectangle<T> enclosing_rectangle(const BasicPolygon<T>& polygon,
+                                      Cost cost) {
+  using real = real_of<T>;
+  using traits = scalar_traits<T>;
+
+  std::vector<BasicPoint<T>> hull = convex_ccw(polygon);
+  size_t n = hull.size();
+  if (n < 3) {
+    throw std::invalid_argument("enclosing_rectangle: degenerate polygon");
+  }
+
+  auto dot = [&](size_t from, size_t to, real ux, real uy) {
+    return (real(hull[to].x) - hull[from].x) * ux +
+           (real(hull[to].y) - hull[from].y) * uy;
+  };
+
+  real best = 0;
+  BasicPoint<T> corners[3] = {hull[0], hull[0], hull[0]};
+  size_t right = 1;
+  size_t top = 1;
+  size_t left = 1;
+  for (size_t i = 0; i < n; ++i) {
+    size_t next = (i + 1) % n;
+    real ex = real(hull[next].x) - hull[i].x;
+    real ey = real(hull[next].y) - hull[i].y;
+    real len = std::sqrt(ex * ex + ey * ey);
+    real ux = ex / len;
+    real uy = ey / len;
+
+    while (dot(right, (right + 1) % n, ux, uy) > 0) {
+      right = (right + 1) % n;
+    }
+    if (i == 0) {
+      top = right;
+    }
+    while (cross(hull[i], hull[next], hull[(top + 1) % n]) >
+           cross(hull[i], hull[next], hull[top])) {
+      top = (top + 1) % n;
+    }
+    if (i == 0) {
+      left = top;
+    }
+    while (dot(left, (left + 1) % n, ux, uy) < 0) {
+      left = (left + 1) % n;
+    }
+
+    real hi = dot(i, right, ux, uy);
+    real lo = dot(i, left, ux, uy);
+    real height = cross(hull[i], hull[next], hull[top]) / len;
+    real cnt = cost(hi - lo, height);
+    if (i == 0 || cnt < best) {
+      best = cnt;
+      real x = hull[i].x;
+      real y = hull[i].y;
+      // нормаль (-uy, ux) смотрит внутрь многоугольника
+      corners[0] = BasicPoint<T>(traits::from_real(x + ux * lo),
+                                 traits::from_real(y + uy * lo));
+      corners[1] = BasicPoint<T>(traits::from_real(x + ux * hi),
+                                 traits::from_real(y + uy * hi));
+      corners[2] = BasicPoint<T>(traits::from_real(x + ux * hi - uy * height),
+                                 traits::from_real(y + uy * hi + ux * height));
+    }
+  }
+
+  // Rectangle(P1, P3, k) поворачивает P1 вокруг центра на -2atan(k)
+  real cx = (real(corners[0].x) + corners[2].x) / 2;
+  real cy = (real(corners[0].y) + corners[2].y) / 2;
+  real first_x = corners[0].x - cx;
+  real first_y = corners[0].y - cy;
+  real second_x = corners[1].x - cx;
+  real second_y = corners[1].y - cy;
+  real angle = std::atan2(first_x * second_y - first_y * second_x,
+                          first_x * second_x + first_y * second_y);
+  return BasicRectangle<T>(corners[0], corners[2], std::tan(-angle / 2));
+}
+}  // namespace detail
+
+// Самая далёкая пара вершин; у многоугольника без вершин её нет -
+// std::invalid_argument.
+template <typename T>
+std::pair<BasicPoint<T>, BasicPoint<T>> diameter(
+    const BasicPolygon<T>& polygon) {
+  std::vector<BasicPoint<T>> hull = detail::convex_ccw(polygon);
+  if (hull.empty()) {
+    throw std::invalid_argument("diameter: empty polygon");
+  }
+  if (hull.size() < 3) {
+    return {hull.front(), hull.back()};
+  }
+
+  std::pair<BasicPoint<T>, BasicPoint<T>> ans(hull[0], hull[0]);
+  typename BasicPoint<T>::real best = 0;
+  detail::for_each_antipodal(hull, [&](size_t i, size_t next, size_t j) {
+    for (size_t k : {i, next}) {
+      auto cnt = hull[k].distance(hull[j]);
+      if (cnt > best) {
+        best = cnt;
+        ans = {hull[k], hull[j]};
+      }
+    }
+  });
+  return ans;
+}
+
+// Наименьшее расстояние между параллельными опорными прямыми.
+template <typename T>
+typename BasicPoint<T>::real width(const BasicPolygon<T>& polygon) {
+  std::vector<BasicPoint<T>> hull = detail::convex_ccw(polygon);
+  if (hull.size() < 3) {
+    return 0;
+  }
+
+  typename BasicPoint<T>::real ans = 0;
+  detail::for_each_antipodal(hull, [&](size_t i, size_t next, size_t j) {
+    auto cnt = detail::cross(hull[i], hull[next], hull[j]) /
+               hull[i].distance(hull[next]);
+    if (i == 0 || cnt < ans) {
+      ans = cnt;
+    }
+  });
+  return ans;
+}
+
+template <typename T>
+BasicRectangle<T> min_area_rectangle(const BasicPolygon<T>& polygon) {
+  return detail::enclosing_rectangle(
+      polygon, [](auto width, auto height) { return width * height; });
+}
+
+template <typename T>
+BasicRectangle<T> min_perimeter_rectangle(const BasicPolygon<T>& polygon) {
+  return detail::enclosing_rectangle(
+      polygon, [](auto width, auto height) { return width + height; });
+}
+
+namespace detail {
+// points[begin, end) отсортированы по x; на выходе - по y (слиянием, как в
+// сортировке слиянием), так что полоса у разреза собирается за линию.
+template <typename T>
+void closest_pair(std::vector<BasicPoint<T>>& points,
+                  std::vector<BasicPoint<T>>& buffer, size_t begin,
+                  size_t end, real_of<T>& best,
+                  std::pair<BasicPoint<T>, BasicPoint<T>>& ans) {
+  using real = real_of<T>;
+  auto by_y = [](const BasicPoint<T>& a, const BasicPoint<T>& b) {
+    return a.y < b.y;
+  };
+  auto update = [&](const BasicPoint<T>& a, const BasicPoint<T>& b) {
+    real cnt = a.distance(b);
+    if (cnt < best) {
+      best = cnt;
+      ans = {a, b};
+    }
+  };
+
+  if (end - begin <= 3) {
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = i + 1; j < end; ++j) {
+        update(points[i], points[j]);
+      }
+    }
+    std::sort(points.begin() + begin, points.begin() + end, by_y);
+    return;
+  }
+
+  size_t middle = begin + (end - begin) / 2;
+  real middle_x = points[middle].x;
+  closest_pair(points, buffer, begin, middle, best, ans);
+  closest_pair(points, buffer, middle, end, best, ans);
+  std::merge(points.begin() + begin, points.begin() + middle,
+             points.begin() + middle, points.begin() + end, buffer.begin(),
+             by_y);
+  std::copy(buffer.begin(), buffer.begin() + (end - begin),
+            points.begin() + begin);
+
+  // в полосе шириной 2 * best у каждой точки не больше 7 соседей выше
+  size_t strip = 0;
+  for (size_t i = begin; i < end; ++i) {
+    if (std::abs(points[i].x - middle_x) >= best) {
+      continue;
+    }
+    for (size_t j = strip; j-- > 0 && points[i].y - buffer[j].y < best;) {
+      update(points[i], buffer[j]);
+    }
+    buffer[strip++] = points[i];
+  }
+}
+}  // namespace detail
+
+// Ближайшая пара точек, O(n log n).
+template <typename T>
+std::pair<BasicPoint<T>, BasicPoint<T>> closest_pair(
+    std::vector<BasicPoint<T>> points) {
+  if (points.size() < 2) {
+    throw std::invalid_argument("closest_pair: fewer than two points");
+  }
+  std::sort(points.begin(), points.end(),
+            [](const BasicPoint<T>& a, const BasicPoint<T>& b) {
+              return a.x < b.x || (a.x == b.x && a.y < b.y);
+            });
+
+  std::vector<BasicPoint<T>> buffer(points.size());
+  auto best = points[0].distance(points[1]);
+  std::pair<BasicPoint<T>, BasicPoint<T>> ans(points[0], points[1]);
+  detail::closest_pair(points, buffer, 0, points.size(), best, ans);
+  return ans;
+}
+}  // namespace my
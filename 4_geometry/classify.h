@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.h"
+#include "parallel.h"
+
+namespace my {
+// Результат классификации в формате CSR: фигуры, содержащие точку i, - это
+// shapes[offsets[i]] ... shapes[offsets[i + 1] - 1], по возрастанию номера.
+struct Classification {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> shapes;
+
+  size_t size() const {
+    return offsets.size() - 1;
+  }
+
+  size_t count(size_t i) const {
+    return offsets[i + 1] - offsets[i];
+  }
+
+  const uint32_t* begin(size_t i) const {
+    return shapes.data() + offsets[i];
+  }
+
+  const uint32_t* end(size_t i) const {
+    return shapes.data() + offsets[i + 1];
+  }
+};
+
+// Равномерная сетка над bbox'ами фигур. В ячейке лежат номера фигур, чей
+// bbox её задевает, поэтому для точки кандидаты - это одна ячейка, а
+// точная проверка containsPoint нужна только для них.
+template <typename T>
+class ShapeIndex {
+ public:
+  using real = typename scalar_traits<T>::real_type;
+
+ private:
+  std::vector<const BasicShape<T>*> shapes_;
+  std::vector<real> boxes_;  // по 4 числа на фигуру
+  real min_x_ = 0;
+  real min_y_ = 0;
+  real inv_cell_w_ = 0;
+  real inv_cell_h_ = 0;
+  size_t cols_ = 0;
+  size_t rows_ = 0;
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> cell_items_;
+
+  size_t column(real x) const {
+    real cell = (x - min_x_) * inv_cell_w_;
+    return std::min(cols_ - 1, static_cast<size_t>(std::max<real>(cell, 0)));
+  }
+
+  size_t row(real y) const {
+    real cell = (y - min_y_) * inv_cell_h_;
+    return std::min(rows_ - 1, static_cast<size_t>(std::max<real>(cell, 0)));
+  }
+
+ public:
+  explicit ShapeIndex(const std::vector<const BasicShape<T>*>& shapes)
+      : shapes_(shapes), boxes_(4 * shapes.size()) {
+    if (shapes_.empty()) {
+      return;
+    }
+
+    // запас на допуск containsPoint у кругов (r + accuracy) и округление;
+    // коробка эллипса уже накрывает его допуск
+    const real kPad = scalar_traits<real>::accuracy;
+    for (size_t i = 0; i < shapes_.size(); ++i) {
+      BoundingBox<real> box = shapes_[i]->boundingBox();
+      boxes_[4 * i] = box.min_x - kPad;
+      boxes_[4 * i + 1] = box.min_y - kPad;
+      boxes_[4 * i + 2] = box.max_x + kPad;
+      boxes_[4 * i + 3] = box.max_y + kPad;
+    }
+
+    real max_x = boxes_[2];
+    real max_y = boxes_[3];
+    min_x_ = boxes_[0];
+    min_y_ = boxes_[1];
+    for (size_t i = 0; i < shapes_.size(); ++i) {
+      min_x_ = std::min(min_x_, boxes_[4 * i]);
+      min_y_ = std::min(min_y_, boxes_[4 * i + 1]);
+      max_x = std::max(max_x, boxes_[4 * i + 2]);
+      max_y = std::max(max_y, boxes_[4 * i + 3]);
+    }
+
+    // порядка одной ячейки на фигуру, стороны ячеек близки к квадрату
+    real width = std::max<real>(max_x - min_x_, kAccuracy);
+    real height = std::max<real>(max_y - min_y_, kAccuracy);
+    real side = std::sqrt(width * height / shapes_.size());
+    cols_ = std::clamp<size_t>(static_cast<size_t>(width / side), 1, 4096);
+    rows_ = std::clamp<size_t>(static_cast<size_t>(height / side), 1, 4096);
+    inv_cell_w_ = cols_ / width;
+    inv_cell_h_ = rows_ / height;
+
+    // два прохода: посчитать, сколько фигур в ячейке, затем разложить
+    cell_start_.assign(cols_ * rows_ + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t i = 0; i < shapes_.size(); ++i) {
+        const real* box = &boxes_[4 * i];
+        for (size_t r = row(box[1]); r <= row(box[3]); ++r) {
+          for (size_t c = column(box[0]); c <= column(box[2]); ++c) {
+            if (pass == 0) {
+              ++cell_start_[r * cols_ + c + 1];
+            } else {
+              cell_items_[cell_start_[r * cols_ + c]++] = i;
+            }
+          }
+        }
+      }
+      if (pass == 0) {
+        for (size_t cell = 0; cell < cols_ * rows_; ++cell) {
+          cell_start_[cell + 1] += cell_start_[cell];
+        }
+        cell_items_.resize(cell_start_.back());
+      } else {
+        // второй проход сдвинул начала на одну ячейку вперёд
+        std::copy_backward(cell_start_.begin(), cell_start_.end() - 1,
+                           cell_start_.end());
+        cell_start_[0] = 0;
+      }
+    }
+  }
+
+  size_t size() const {
+    return shapes_.size();
+  }
+
+  // Дописывает в ans номера фигур, содержащих точку.
+  void query(const BasicPoint<T>& point, std::vector<uint32_t>& ans) const {
+    if (shapes_.empty()) {
+      return;
+    }
+    real x = point.x;
+    real y = point.y;
+    size_t cell = row(y) * cols_ + column(x);
+    for (uint32_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+      uint32_t id = cell_items_[k];
+      const real* box = &boxes_[4 * id];
+      if (box[0] <= x && x <= box[2] && box[1] <= y && y <= box[3] &&
+          shapes_[id]->containsPoint(point)) {
+        ans.push_back(id);
+      }
+    }
+  }
+
+  // Точки режутся на куски, свободный поток забирает следующий кусок
+  // (parallel_for), так что перекос плотности точек не простаивает ядра.
+  // Каждый кусок пишет ответы в свой буфер; после префиксной суммы буферы
+  // копируются на свои места в общий массив.
+  Classification classify(const std::vector<BasicPoint<T>>& points,
+                          size_t threads = default_threads()) const {
+    const size_t kGrain = 1 << 12;
+    size_t chunks = (points.size() + kGrain - 1) / kGrain;
+    std::vector<std::vector<uint32_t>> buffers(chunks);
+
+    Classification ans;
+    ans.offsets.assign(points.size() + 1, 0);
+
+    parallel_for(points.size(), threads, kGrain,
+                 [&](size_t begin, size_t end) {
+                   std::vector<uint32_t>& buffer = buffers[begin / kGrain];
+                   for (size_t i = begin; i < end; ++i) {
+                     size_t before = buffer.size();
+                     query(points[i], buffer);
+                     ans.offsets[i + 1] = buffer.size() - before;
+                   }
+                 });
+
+    for (size_t i = 0; i < points.size(); ++i) {
+      ans.offsets[i + 1] += ans.offsets[i];
+    }
+    ans.shapes.resize(ans.offsets.back());
+
+    parallel_for(chunks, threads, 1, [&](size_t begin, size_t end) {
+      for (size_t chunk = begin; chunk < end; ++chunk) {
+        std::copy(buffers[chunk].begin(), buffers[chunk].end(),
+                  ans.shapes.begin() + ans.offsets[chunk * kGrain]);
+      }
+    });
+    return ans;
+  }
+};
+
+template <typename T>
+Classification classify(const std::vector<BasicPoint<T>>& points,
+                        const std::vector<const BasicShape<T>*>& shapes,
+                        size_t threads = default_threads()) {
+  return ShapeIndex<T>(shapes).classify(points, threads);
+}
+}  // namespace my
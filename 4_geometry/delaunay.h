@@ -0,0 +1,638 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "geometry.h"
+#include "mesh.h"
+#include "parallel.h"
+
+namespace my {
+namespace detail {
+// Индекс точки на кривой Гильберта в сетке 2^16 x 2^16: соседние по индексу
+// точки близки на плоскости, поэтому вставка в таком порядке ищет
+// треугольник рядом с предыдущим.
+inline uint32_t hilbert_index(uint32_t x, uint32_t y) {
+  uint32_t d = 0;
+  for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = s - 1 - x;
+        y = s - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+// Инкрементальный алгоритм Боуэра-Уотсона. Вместо супертреугольника
+// используются призрачные треугольники (u, v, inf) за каждым ребром
+// оболочки, так что оболочка получается точной. Все решения принимаются
+// точными предикатами orient2d и incircle.
+template <typename T>
+class DelaunayBuilder {
+ public:
+  static constexpr uint32_t kInf = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+ private:
+  const std::vector<BasicPoint<T>>& points_;
+
+  std::vector<std::array<uint32_t, 3>> tri_;
+  // adj_[t][k] - соседний треугольник через ребро напротив вершины k
+  std::vector<std::array<uint32_t, 3>> adj_;
+  std::vector<uint8_t> dead_;
+  std::vector<uint32_t> free_;
+
+  // метки обхода полости: stamp_ == epoch_ - треугольник уже проверен
+  std::vector<uint32_t> stamp_;
+  std::vector<uint8_t> conflict_;
+  uint32_t epoch_ = 0;
+
+  struct BoundaryEdge {
+    uint32_t u;
+    uint32_t v;
+    uint32_t outside;
+    uint32_t outside_slot;
+    uint32_t created;
+  };
+
+  std::vector<uint32_t> cavity_;
+  std::vector<uint32_t> stack_;
+  std::vector<BoundaryEdge> boundary_;
+
+  // пространственный хэш: для клетки сетки - недавно созданный треугольник
+  double min_x_ = 0;
+  double min_y_ = 0;
+  double cell_scale_x_ = 0;
+  double cell_scale_y_ = 0;
+  size_t grid_size_ = 1;
+  std::vector<uint32_t> hint_;
+  uint32_t last_ = kNone;
+  uint32_t random_ = 2463534242u;
+
+  size_t inserted_ = 0;
+
+  const BasicPoint<T>& point(uint32_t i) const {
+    return points_[i];
+  }
+
+  bool is_ghost(uint32_t t) const {
+    return tri_[t][2] == kInf;
+  }
+
+  uint32_t next_random() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    return random_;
+  }
+
+  size_t cell(const BasicPoint<T>& p) const {
+    auto clamp = [this](double value) {
+      return std::min(grid_size_ - 1,
+                      static_cast<size_t>(std::max(0., value)));
+    };
+    return clamp((double(p.y) - min_y_) * cell_scale_y_) * grid_size_ +
+           clamp((double(p.x) - min_x_) * cell_scale_x_);
+  }
+
+  uint32_t new_triangle(uint32_t a, uint32_t b, uint32_t c) {
+    // призрачная вершина всегда на последнем месте
+    if (a == kInf) {
+      std::tie(a, b, c) = std::make_tuple(b, c, a);
+    } else if (b == kInf) {
+      std::tie(a, b, c) = std::make_tuple(c, a, b);
+    }
+
+    uint32_t t = 0;
+    if (!free_.empty()) {
+      t = free_.back();
+      free_.pop_back();
+      tri_[t] = {a, b, c};
+      adj_[t] = {kNone, kNone, kNone};
+      dead_[t] = 0;
+    } else {
+      t = static_cast<uint32_t>(tri_.size());
+      tri_.push_back({a, b, c});
+      adj_.push_back({kNone, kNone, kNone});
+      dead_.push_back(0);
+      stamp_.push_back(0);
+      conflict_.push_back(0);
+    }
+    return t;
+  }
+
+  uint32_t slot_of(uint32_t t, uint32_t vertex) const {
+    return tri_[t][0] == vertex ? 0 : (tri_[t][1] == vertex ? 1 : 2);
+  }
+
+  // слот в t, напротив которого лежит ребро (u, v) в любом направлении
+  uint32_t slot_opposite(uint32_t t, uint32_t u, uint32_t v) const {
+    for (uint32_t k = 0; k < 3; ++k) {
+      if (tri_[t][k] != u && tri_[t][k] != v) {
+        return k;
+      }
+    }
+    return 0;
+  }
+
+  bool strictly_between(const BasicPoint<T>& u, const BasicPoint<T>& v,
+                        const BasicPoint<T>& p) const {
+    if (u.x != v.x) {
+      return std::min(u.x, v.x) < p.x && p.x < std::max(u.x, v.x);
+    }
+    return std::min(u.y, v.y) < p.y && p.y < std::max(u.y, v.y);
+  }
+
+  bool in_conflict(uint32_t t, const BasicPoint<T>& p) const {
+    const auto& v = tri_[t];
+    if (v[2] == kInf) {
+      // снаружи призрачного (u, v, inf) - слева от u -> v
+      double orientation = orient2d(point(v[0]), point(v[1]), p);
+      return orientation > 0 ||
+             (orientation == 0 &&
+              strictly_between(point(v[0]), point(v[1]), p));
+    }
+    return incircle(point(v[0]), point(v[1]), point(v[2]), p) > 0;
+  }
+
+  // Шагаем через ребро, за которым лежит p, пока не придём в треугольник,
+  // содержащий p, или за оболочку - в призрачный.
+  uint32_t locate(const BasicPoint<T>& p) {
+    uint32_t t = last_;
+    uint32_t hint = hint_[cell(p)];
+    if (hint != kNone && dead_[hint] == 0 && !is_ghost(hint)) {
+      t = hint;
+    }
+
+    while (true) {
+      uint32_t start = next_random() % 3;
+      bool moved = false;
+      for (uint32_t i = 0; i < 3; ++i) {
+        uint32_t k = (start + i) % 3;
+        const auto& v = tri_[t];
+        if (orient2d(point(v[(k + 1) % 3]), point(v[(k + 2) % 3]), p) < 0) {
+          t = adj_[t][k];
+          moved = true;
+          break;
+        }
+      }
+      if (!moved || is_ghost(t)) {
+        return t;
+      }
+    }
+  }
+
+  void link(uint32_t first, uint32_t first_slot, uint32_t second,
+            uint32_t second_slot) {
+    adj_[first][first_slot] = second;
+    adj_[second][second_slot] = first;
+  }
+
+  void create_first(uint32_t a, uint32_t b, uint32_t c) {
+    std::array<uint32_t, 4> created = {
+        new_triangle(a, b, c), new_triangle(c, b, kInf),
+        new_triangle(a, c, kInf), new_triangle(b, a, kInf)};
+
+    for (size_t i = 0; i < created.size(); ++i) {
+      for (size_t j = i + 1; j < created.size(); ++j) {
+        for (uint32_t k = 0; k < 3; ++k) {
+          uint32_t u = tri_[created[i]][(k + 1) % 3];
+          uint32_t v = tri_[created[i]][(k + 2) % 3];
+          uint32_t other = slot_opposite(created[j], u, v);
+          if (tri_[created[j]][(other + 1) % 3] == v &&
+              tri_[created[j]][(other + 2) % 3] == u) {
+            link(created[i], k, created[j], other);
+          }
+        }
+      }
+    }
+    last_ = created[0];
+    inserted_ = 3;
+  }
+
+  void insert(uint32_t index) {
+    const BasicPoint<T>& p = point(index);
+    uint32_t start = locate(p);
+
+    if (!is_ghost(start)) {
+      for (uint32_t vertex : tri_[start]) {
+        if (point(vertex).x == p.x && point(vertex).y == p.y) {
+          return;  // точка уже есть
+        }
+      }
+    }
+
+    ++epoch_;
+    cavity_.clear();
+    boundary_.clear();
+    stack_.assign(1, start);
+    stamp_[start] = epoch_;
+    conflict_[start] = 1;
+
+    while (!stack_.empty()) {
+      uint32_t t = stack_.back();
+      stack_.pop_back();
+      cavity_.push_back(t);
+
+      for (uint32_t k = 0; k < 3; ++k) {
+        uint32_t n = adj_[t][k];
+        if (stamp_[n] != epoch_) {
+          stamp_[n] = epoch_;
+          conflict_[n] = in_conflict(n, p);
+          if (conflict_[n] != 0) {
+            stack_.push_back(n);
+            continue;
+          }
+        }
+        if (conflict_[n] == 0) {
+          uint32_t u = tri_[t][(k + 1) % 3];
+          uint32_t v = tri_[t][(k + 2) % 3];
+          boundary_.push_back({u, v, n, slot_opposite(n, u, v), kNone});
+        }
+      }
+    }
+
+    for (uint32_t t : cavity_) {
+      dead_[t] = 1;
+      free_.push_back(t);
+    }
+
+    for (auto& edge : boundary_) {
+      edge.created = new_triangle(edge.u, edge.v, index);
+      link(edge.created, slot_of(edge.created, index), edge.outside,
+           edge.outside_slot);
+    }
+
+    // ребро (v, p) нового треугольника общее с тем, чьё ребро оболочки
+    // полости начинается в v
+    for (const auto& edge : boundary_) {
+      for (const auto& other : boundary_) {
+        if (other.u == edge.v) {
+          link(edge.created, slot_of(edge.created, edge.u), other.created,
+               slot_of(other.created, other.v));
+          break;
+        }
+      }
+      if (!is_ghost(edge.created)) {
+        last_ = edge.created;
+      }
+    }
+    hint_[cell(p)] = last_;
+    ++inserted_;
+  }
+
+ public:
+  DelaunayBuilder(const std::vector<BasicPoint<T>>& points)
+      : points_(points) {}
+
+  // Триангулирует точки с номерами из ids (в любом порядке).
+  void run(std::vector<uint32_t> ids) {
+    if (ids.empty()) {
+      return;
+    }
+
+    double max_x = min_x_ = points_[ids[0]].x;
+    double max_y = min_y_ = points_[ids[0]].y;
+    for (uint32_t id : ids) {
+      min_x_ = std::min<double>(min_x_, points_[id].x);
+      min_y_ = std::min<double>(min_y_, points_[id].y);
+      max_x = std::max<double>(max_x, points_[id].x);
+      max_y = std::max<double>(max_y, points_[id].y);
+    }
+
+    double scale_x = max_x > min_x_ ? 65535. / (max_x - min_x_) : 0;
+    double scale_y = max_y > min_y_ ? 65535. / (max_y - min_y_) : 0;
+    std::vector<std::pair<uint32_t, uint32_t>> order;
+    order.reserve(ids.size());
+    for (uint32_t id : ids) {
+      order.emplace_back(
+          hilbert_index(
+              static_cast<uint32_t>((points_[id].x - min_x_) * scale_x),
+              static_cast<uint32_t>((points_[id].y - min_y_) * scale_y)),
+          id);
+    }
+    std::sort(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); ++i) {
+      ids[i] = order[i].second;
+    }
+
+    grid_size_ = std::max<size_t>(
+        1, static_cast<size_t>(std::sqrt(double(ids.size()) / 4)));
+    cell_scale_x_ = max_x > min_x_ ? grid_size_ / (max_x - min_x_) : 0;
+    cell_scale_y_ = max_y > min_y_ ? grid_size_ / (max_y - min_y_) : 0;
+    hint_.assign(grid_size_ * grid_size_, kNone);
+
+    tri_.reserve(2 * ids.size() + 4);
+    adj_.reserve(2 * ids.size() + 4);
+
+    // первый невырожденный треугольник
+    size_t second = 1;
+    while (second < ids.size() &&
+           points_[ids[second]].x == points_[ids[0]].x &&
+           points_[ids[second]].y == points_[ids[0]].y) {
+      ++second;
+    }
+    size_t third = second + 1;
+    while (third < ids.size() &&
+           orient2d(points_[ids[0]], points_[ids[second]],
+                    points_[ids[third]]) == 0) {
+      ++third;
+    }
+    if (third >= ids.size()) {
+      return;  // все точки на одной прямой
+    }
+
+    if (orient2d(points_[ids[0]], points_[ids[second]],
+                 points_[ids[third]]) > 0) {
+      create_first(ids[0], ids[second], ids[third]);
+    } else {
+      create_first(ids[0], ids[third], ids[second]);
+    }
+
+    for (size_t i = 1; i < ids.size(); ++i) {
+      if (i != second && i != third) {
+        insert(ids[i]);
+      }
+    }
+  }
+
+  // число различных вставленных точек
+  size_t inserted() const {
+    return inserted_;
+  }
+
+  template <typename Func>
+  void for_each_triangle(Func func) const {
+    for (uint32_t t = 0; t < tri_.size(); ++t) {
+      if (dead_[t] == 0 && !is_ghost(t)) {
+        func(t, tri_[t], adj_[t]);
+      }
+    }
+  }
+
+  bool is_ghost_or_none(uint32_t t) const {
+    return t == kNone || is_ghost(t);
+  }
+
+  const std::array<uint32_t, 3>& vertices(uint32_t t) const {
+    return tri_[t];
+  }
+
+  uint32_t neighbour(uint32_t t, uint32_t k) const {
+    return adj_[t][k];
+  }
+
+  size_t hull_size() const {
+    size_t ans = 0;
+    for (uint32_t t = 0; t < tri_.size(); ++t) {
+      ans += dead_[t] == 0 && is_ghost(t);
+    }
+    return ans;
+  }
+
+  // размер массивов треугольников, включая удалённые и призрачные
+  size_t slots() const {
+    return tri_.size();
+  }
+};
+
+inline uint64_t edge_key(uint32_t u, uint32_t v) {
+  return (uint64_t(u) << 32) | v;
+}
+
+template <typename T>
+std::vector<uint32_t> delaunay_sequential(
+    const std::vector<BasicPoint<T>>& points) {
+  std::vector<uint32_t> ids(points.size());
+  for (uint32_t i = 0; i < ids.size(); ++i) {
+    ids[i] = i;
+  }
+
+  DelaunayBuilder<T> builder(points);
+  builder.run(std::move(ids));
+
+  std::vector<uint32_t> indices;
+  builder.for_each_triangle([&](uint32_t, const auto& v, const auto&) {
+    indices.insert(indices.end(), v.begin(), v.end());
+  });
+  return indices;
+}
+
+// Параллельный режим: точки делятся по x на полосы, каждая триангулируется
+// отдельно. Треугольник полосы, чья описанная окружность целиком внутри
+// полосы и не касается её оболочки, заведомо есть в общей триангуляции.
+// Остальное пространство заново триангулируется по вершинам
+// неподтверждённых треугольников и добирается обходом от рёбер
+// подтверждённой области. Результат проверяется, а при вырожденных входах
+// (много точек на одной окружности на стыке полос) считается
+// последовательно.
+template <typename T>
+std::vector<uint32_t> delaunay_parallel(
+    const std::vector<BasicPoint<T>>& points, size_t threads) {
+  using Builder = DelaunayBuilder<T>;
+
+  std::vector<uint32_t> sorted(points.size());
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    sorted[i] = i;
+  }
+  std::sort(sorted.begin(), sorted.end(), [&](uint32_t lhs, uint32_t rhs) {
+    return points[lhs].x < points[rhs].x ||
+           (points[lhs].x == points[rhs].x && points[lhs].y < points[rhs].y);
+  });
+
+  // границы полос сдвигаются так, чтобы одинаковые x не попали в разные
+  std::vector<size_t> bounds = {0};
+  for (size_t i = 1; i < threads; ++i) {
+    size_t split = std::max(bounds.back(), sorted.size() * i / threads);
+    while (split > 0 && split < sorted.size() &&
+           points[sorted[split]].x == points[sorted[split - 1]].x) {
+      ++split;
+    }
+    if (split > bounds.back() && split < sorted.size()) {
+      bounds.push_back(split);
+    }
+  }
+  bounds.push_back(sorted.size());
+  size_t strips = bounds.size() - 1;
+
+  std::vector<std::vector<uint32_t>> certified(strips);
+  std::vector<std::vector<uint64_t>> barriers(strips);
+  std::vector<size_t> inserted(strips);
+  // полосы не пересекаются по точкам, так что потоки пишут в разные байты
+  std::vector<uint8_t> in_rest(points.size(), 0);
+  std::vector<uint8_t> on_hull(points.size(), 0);
+
+  parallel_for(strips, threads, 1, [&](size_t begin, size_t end) {
+    for (size_t s = begin; s < end; ++s) {
+      double low = s == 0 ? -std::numeric_limits<double>::infinity()
+                          : double(points[sorted[bounds[s] - 1]].x);
+      double high = s + 1 == strips
+                        ? std::numeric_limits<double>::infinity()
+                        : double(points[sorted[bounds[s + 1]]].x);
+
+      Builder builder(points);
+      builder.run(std::vector<uint32_t>(sorted.begin() + bounds[s],
+                                        sorted.begin() + bounds[s + 1]));
+      inserted[s] = builder.inserted();
+
+      if (builder.inserted() < 3) {
+        // все точки полосы на одной прямой
+        inserted[s] = 1;
+        in_rest[sorted[bounds[s]]] = 1;
+        for (size_t i = bounds[s] + 1; i < bounds[s + 1]; ++i) {
+          in_rest[sorted[i]] = 1;
+          inserted[s] += points[sorted[i]].x != points[sorted[i - 1]].x ||
+                         points[sorted[i]].y != points[sorted[i - 1]].y;
+        }
+        continue;
+      }
+
+      // вершины на оболочке полосы не подтверждаются
+      builder.for_each_triangle([&](uint32_t, const auto& v, const auto& adj) {
+        for (uint32_t k = 0; k < 3; ++k) {
+          if (builder.is_ghost_or_none(adj[k])) {
+            on_hull[v[(k + 1) % 3]] = 1;
+            on_hull[v[(k + 2) % 3]] = 1;
+          }
+        }
+      });
+
+      std::vector<uint8_t> good(builder.slots(), 0);
+      builder.for_each_triangle([&](uint32_t t, const auto& v, const auto&) {
+        if (on_hull[v[0]] + on_hull[v[1]] + on_hull[v[2]] > 0) {
+          return;
+        }
+        double ax = points[v[0]].x;
+        double bx = double(points[v[1]].x) - ax;
+        double by = double(points[v[1]].y) - double(points[v[0]].y);
+        double cx = double(points[v[2]].x) - ax;
+        double cy = double(points[v[2]].y) - double(points[v[0]].y);
+        double b_len2 = bx * bx + by * by;
+        double c_len2 = cx * cx + cy * cy;
+        double cross = bx * cy - by * cx;
+        double ux = (cy * b_len2 - by * c_len2) / (2 * cross);
+        double uy = (bx * c_len2 - cx * b_len2) / (2 * cross);
+        double radius = std::hypot(ux, uy);
+        double center = ax + ux;
+        // запас на погрешность центра и радиуса
+        double margin = 1e-9 * (std::abs(center) + radius);
+        good[t] =
+            center - radius - margin > low && center + radius + margin < high;
+      });
+
+      builder.for_each_triangle([&](uint32_t t, const auto& v, const auto& adj) {
+        if (good[t] == 0) {
+          in_rest[v[0]] = in_rest[v[1]] = in_rest[v[2]] = 1;
+          return;
+        }
+        certified[s].insert(certified[s].end(), v.begin(), v.end());
+        for (uint32_t k = 0; k < 3; ++k) {
+          if (good[adj[k]] == 0) {
+            // с другой стороны ребро идёт в обратную сторону
+            barriers[s].push_back(edge_key(v[(k + 2) % 3], v[(k + 1) % 3]));
+          }
+        }
+      });
+    }
+  });
+
+  std::vector<uint32_t> rest_ids;
+  for (uint32_t i = 0; i < points.size(); ++i) {
+    if (in_rest[i] != 0) {
+      rest_ids.push_back(i);
+    }
+  }
+
+  std::vector<uint64_t> barrier_edges;
+  std::vector<uint32_t> indices;
+  size_t distinct = 0;
+  for (size_t s = 0; s < strips; ++s) {
+    barrier_edges.insert(barrier_edges.end(), barriers[s].begin(),
+                         barriers[s].end());
+    indices.insert(indices.end(), certified[s].begin(), certified[s].end());
+    distinct += inserted[s];
+  }
+  std::sort(barrier_edges.begin(), barrier_edges.end());
+  auto is_barrier = [&](uint32_t u, uint32_t v) {
+    return std::binary_search(barrier_edges.begin(), barrier_edges.end(),
+                              edge_key(u, v));
+  };
+
+  Builder builder(points);
+  builder.run(rest_ids);
+
+  if (barrier_edges.empty()) {
+    builder.for_each_triangle([&](uint32_t, const auto& v, const auto&) {
+      indices.insert(indices.end(), v.begin(), v.end());
+    });
+  } else {
+    std::vector<uint8_t> taken(builder.slots(), 0);
+    std::vector<uint32_t> stack;
+    size_t matched = 0;
+    builder.for_each_triangle([&](uint32_t t, const auto& v, const auto&) {
+      for (uint32_t k = 0; k < 3; ++k) {
+        if (is_barrier(v[k], v[(k + 1) % 3])) {
+          ++matched;
+          if (taken[t] == 0) {
+            taken[t] = 1;
+            stack.push_back(t);
+          }
+        }
+      }
+    });
+
+    // Общая граница должна целиком найтись в DT(S), а число треугольников
+    // сойтись с формулой Эйлера t = 2n - 2 - h (оболочка у S та же, что у
+    // всех точек). Иначе на стыке вырожденный случай.
+    if (matched != barrier_edges.size()) {
+      return delaunay_sequential(points);
+    }
+
+    while (!stack.empty()) {
+      uint32_t t = stack.back();
+      stack.pop_back();
+      const auto& v = builder.vertices(t);
+      indices.insert(indices.end(), v.begin(), v.end());
+
+      for (uint32_t k = 0; k < 3; ++k) {
+        uint32_t n = builder.neighbour(t, k);
+        if (!is_barrier(v[(k + 1) % 3], v[(k + 2) % 3]) &&
+            !builder.is_ghost_or_none(n) && taken[n] == 0) {
+          taken[n] = 1;
+          stack.push_back(n);
+        }
+      }
+    }
+  }
+
+  if (indices.size() / 3 + 2 + builder.hull_size() != 2 * distinct) {
+    return delaunay_sequential(points);
+  }
+  return indices;
+}
+}  // namespace detail
+
+// Триангуляция Делоне. Буфер вершин результата - сами точки (повторы
+// остаются, но не используются), треугольники ориентированы против часовой
+// стрелки. threads > 1 включает параллельный режим по полосам.
+template <typename T>
+TriangleMesh<T> delaunay(const std::vector<BasicPoint<T>>& points,
+                         size_t threads = 1) {
+  TriangleMesh<T> mesh;
+  mesh.vertices = points;
+  mesh.indices = threads > 1 && points.size() > 64 * threads
+                     ? detail::delaunay_parallel(points, threads)
+                     : detail::delaunay_sequential(points);
+  return mesh;
+}
+}  // namespace my
@@ -1,264 +1,874 @@
+#pragma once
+
 #include <algorithm>
 #include <cmath>
-
-class Line;
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
 
 namespace my {
-const double kAccuracy = 1e-6;
+// Точность сравнений и тип, в котором считаются длины, углы и площади.
+// Для целых (фиксированная точка) координаты сравниваются точно, а
+// результаты поворотов и масштабирований округляются обратно.
+template <typename T>
+struct scalar_traits {
+  using real_type = T;
+
+  static constexpr T accuracy = T(1e-6);
+
+  static bool equal(T first, T second) {
+    return std::abs(first - second) < accuracy;
+  }
+
+  // Равенство с точностью до kUlps ulp от scale, но не меньше ulp единицы:
+  // ошибка округления пропорциональна величинам, из которых число
+  // получено, а не самому числу (поворот (1, 0) на 90 градусов даёт
+  // x ~ 1e-17). Прежние 1e-6 склеивали 1e-8 с 5e-7 и 1e9 с 1e9 + 500.
+  static constexpr T kUlps = T(64);
+
+  static bool scaled_equal(T first, T second, T scale) {
+    return std::abs(first - second) <=
+           kUlps * std::numeric_limits<T>::epsilon() * std::max(T(1), scale);
+  }
+
+  static bool scaled_equal(T first, T second) {
+    return scaled_equal(first, second,
+                        std::max(std::abs(first), std::abs(second)));
+  }
+
+  static T from_real(real_type value) {
+    return value;
+  }
+};
+
+template <>
+struct scalar_traits<float> {
+  using real_type = float;
+
+  static constexpr float accuracy = 1e-4f;
+
+  static bool equal(float first, float second) {
+    return std::abs(first - second) < accuracy;
+  }
+
+  static constexpr float kUlps = 64;
+
+  static bool scaled_equal(float first, float second, float scale) {
+    return std::abs(first - second) <=
+           kUlps * std::numeric_limits<float>::epsilon() * std::max(1.f, scale);
+  }
+
+  static bool scaled_equal(float first, float second) {
+    return scaled_equal(first, second,
+                        std::max(std::abs(first), std::abs(second)));
+  }
+
+  static float from_real(float value) {
+    return value;
+  }
+};
+
+template <std::integral T>
+struct scalar_traits<T> {
+  using real_type = double;
 
-class Vector;
+  static constexpr T accuracy = 0;
 
-bool double_equal(double first, double second) {
-  return std::abs(first - second) < kAccuracy;
+  static bool equal(T first, T second) {
+    return first == second;
+  }
+
+  static bool scaled_equal(T first, T second, T = 0) {
+    return first == second;
+  }
+
+  static T from_real(real_type value) {
+    return static_cast<T>(std::llround(value));
+  }
+};
+
+const double kAccuracy = scalar_traits<double>::accuracy;
+
+template <typename T>
+class BasicVector;
+
+inline bool double_equal(double first, double second) {
+  return scalar_traits<double>::equal(first, second);
 }
+
+inline bool scaled_equal(double first, double second) {
+  return scalar_traits<double>::scaled_equal(first, second);
 }
+}  // namespace my
 
-class Point {
+template <typename T>
+class BasicLine;
+
+template <typename T>
+class BasicPoint {
  public:
-  double x;
-  double y;
+  using traits = my::scalar_traits<T>;
+  using real = typename traits::real_type;
+
+  T x;
+  T y;
 
-  Point() = default;
+  BasicPoint() = default;
 
-  Point(double x, double y) : x(x), y(y) {}
+  BasicPoint(T x, T y) : x(x), y(y) {}
 
-  Point(const my::Vector&);
+  BasicPoint(const my::BasicVector<T>&);
 
-  bool operator==(const Point& other) const {
-    return my::double_equal(x, other.x) && my::double_equal(y, other.y);
+  // Масштаб общий для обеих координат: x порядка 1e-17 рядом с y = 1 -
+  // ошибка округления, а не другая точка.
+  bool operator==(const BasicPoint& other) const {
+    T scale = std::max({std::abs(x), std::abs(y), std::abs(other.x),
+                        std::abs(other.y)});
+    return traits::scaled_equal(x, other.x, scale) &&
+           traits::scaled_equal(y, other.y, scale);
   }
 
-  bool operator!=(const Point& other) const {
+  bool operator!=(const BasicPoint& other) const {
     return !(*this == other);
   }
 
-  Point symmetrical(const Line& line) const;
+  BasicPoint symmetrical(const BasicLine<T>& line) const;
 
-  double distance(const Point& other) const {
-    return std::sqrt(std::pow(x - other.x, 2) + std::pow(y - other.y, 2));
+  real distance(const BasicPoint& other) const {
+    return std::sqrt(std::pow(real(x) - real(other.x), 2) +
+                     std::pow(real(y) - real(other.y), 2));
   }
 };
 
+using Point = BasicPoint<double>;
+
+// Адаптивные предикаты Шевчука: сначала дешёвый фильтр с оценкой ошибки,
+// и только если он не уверен в знаке - точная арифметика на разложениях
+// (expansion), где число представлено суммой неперекрывающихся double.
 namespace my {
-class Vector {
+namespace predicates {
+const double kEpsilon = std::ldexp(1., -53);
+const double kResultErrBound = (3 + 8 * kEpsilon) * kEpsilon;
+const double kCcwErrBoundA = (3 + 16 * kEpsilon) * kEpsilon;
+const double kCcwErrBoundB = (2 + 12 * kEpsilon) * kEpsilon;
+const double kCcwErrBoundC = (9 + 64 * kEpsilon) * kEpsilon * kEpsilon;
+const double kIccErrBoundA = (10 + 96 * kEpsilon) * kEpsilon;
+
+using Expansion = std::vector<double>;
+
+inline void two_sum(double a, double b, double& x, double& y) {
+  x = a + b;
+  double b_virt = x - a;
+  double a_virt = x - b_virt;
+  y = (a - a_virt) + (b - b_virt);
+}
+
+inline void two_diff(double a, double b, double& x, double& y) {
+  x = a - b;
+  double b_virt = a - x;
+  double a_virt = x + b_virt;
+  y = (a - a_virt) + (b_virt - b);
+}
+
+inline void two_product(double a, double b, double& x, double& y) {
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+inline double diff_tail(double a, double b, double x) {
+  double b_virt = a - x;
+  double a_virt = x + b_virt;
+  return (a - a_virt) + (b_virt - b);
+}
+
+// fast_expansion_sum_zeroelim
+inline Expansion sum(const Expansion& e, const Expansion& f) {
+  Expansion h;
+  h.reserve(e.size() + f.size());
+  size_t ei = 0;
+  size_t fi = 0;
+  auto next = [&]() {
+    if (fi == f.size() ||
+        (ei < e.size() && std::abs(e[ei]) < std::abs(f[fi]))) {
+      return e[ei++];
+    }
+    return f[fi++];
+  };
+
+  if (e.empty() || f.empty()) {
+    h = e.empty() ? f : e;
+    return h;
+  }
+
+  double q = next();
+  double hh = 0;
+  while (ei < e.size() || fi < f.size()) {
+    two_sum(q, next(), q, hh);
+    if (hh != 0) {
+      h.push_back(hh);
+    }
+  }
+  if (q != 0 || h.empty()) {
+    h.push_back(q);
+  }
+  return h;
+}
+
+// scale_expansion_zeroelim
+inline Expansion scale(const Expansion& e, double b) {
+  Expansion h;
+  h.reserve(2 * e.size());
+  if (e.empty()) {
+    return h;
+  }
+  double q = 0;
+  double hh = 0;
+  two_product(e[0], b, q, hh);
+  if (hh != 0) {
+    h.push_back(hh);
+  }
+  for (size_t i = 1; i < e.size(); ++i) {
+    double product = 0;
+    double product_tail = 0;
+    two_product(e[i], b, product, product_tail);
+    double sum_ = 0;
+    two_sum(q, product_tail, sum_, hh);
+    if (hh != 0) {
+      h.push_back(hh);
+    }
+    two_sum(product, sum_, q, hh);
+    if (hh != 0) {
+      h.push_back(hh);
+    }
+  }
+  if (q != 0 || h.empty()) {
+    h.push_back(q);
+  }
+  return h;
+}
+
+inline Expansion product(const Expansion& e, const Expansion& f) {
+  Expansion ans;
+  for (double elem : f) {
+    ans = sum(ans, scale(e, elem));
+  }
+  return ans;
+}
+
+inline Expansion negated(Expansion e) {
+  for (double& elem : e) {
+    elem = -elem;
+  }
+  return e;
+}
+
+inline Expansion exact_diff(double a, double b) {
+  double x = 0;
+  double y = 0;
+  two_diff(a, b, x, y);
+  return y != 0 ? Expansion{y, x} : Expansion{x};
+}
+
+// старшая компонента разложения имеет знак всего числа
+inline double most_significant(const Expansion& e) {
+  return e.empty() ? 0 : e.back();
+}
+
+inline double orient2d_exact(const Point& a, const Point& b, const Point& c) {
+  Expansion acx = exact_diff(a.x, c.x);
+  Expansion acy = exact_diff(a.y, c.y);
+  Expansion bcx = exact_diff(b.x, c.x);
+  Expansion bcy = exact_diff(b.y, c.y);
+  return most_significant(
+      sum(product(acx, bcy), negated(product(acy, bcx))));
+}
+
+inline double orient2d_adapt(const Point& a, const Point& b, const Point& c,
+                             double detsum) {
+  double acx = a.x - c.x;
+  double bcx = b.x - c.x;
+  double acy = a.y - c.y;
+  double bcy = b.y - c.y;
+
+  double detleft = 0;
+  double detleft_tail = 0;
+  double detright = 0;
+  double detright_tail = 0;
+  two_product(acx, bcy, detleft, detleft_tail);
+  two_product(acy, bcx, detright, detright_tail);
+
+  Expansion det_b =
+      sum(Expansion{detleft_tail, detleft},
+          Expansion{-detright_tail, -detright});
+  double det = 0;
+  for (double elem : det_b) {
+    det += elem;
+  }
+
+  double errbound = kCcwErrBoundB * detsum;
+  if (det >= errbound || -det >= errbound) {
+    return det;
+  }
+
+  double acx_tail = diff_tail(a.x, c.x, acx);
+  double bcx_tail = diff_tail(b.x, c.x, bcx);
+  double acy_tail = diff_tail(a.y, c.y, acy);
+  double bcy_tail = diff_tail(b.y, c.y, bcy);
+
+  if (acx_tail == 0 && acy_tail == 0 && bcx_tail == 0 && bcy_tail == 0) {
+    return det;
+  }
+
+  errbound = kCcwErrBoundC * detsum + kResultErrBound * std::abs(det);
+  det += (acx * bcy_tail + bcy * acx_tail) - (acy * bcx_tail + bcx * acy_tail);
+  if (det >= errbound || -det >= errbound) {
+    return det;
+  }
+
+  return orient2d_exact(a, b, c);
+}
+
+inline double incircle_exact(const Point& a, const Point& b, const Point& c,
+                             const Point& d) {
+  Expansion adx = exact_diff(a.x, d.x);
+  Expansion ady = exact_diff(a.y, d.y);
+  Expansion bdx = exact_diff(b.x, d.x);
+  Expansion bdy = exact_diff(b.y, d.y);
+  Expansion cdx = exact_diff(c.x, d.x);
+  Expansion cdy = exact_diff(c.y, d.y);
+
+  Expansion alift = sum(product(adx, adx), product(ady, ady));
+  Expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+  Expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+
+  Expansion bc = sum(product(bdx, cdy), negated(product(cdx, bdy)));
+  Expansion ca = sum(product(cdx, ady), negated(product(adx, cdy)));
+  Expansion ab = sum(product(adx, bdy), negated(product(bdx, ady)));
+
+  return most_significant(sum(
+      sum(product(alift, bc), product(blift, ca)), product(clift, ab)));
+}
+}  // namespace predicates
+
+// > 0, если a, b, c идут против часовой стрелки, < 0 - по часовой,
+// 0 - точно на одной прямой. Модуль приближает удвоенную площадь abc.
+inline double orient2d(const Point& a, const Point& b, const Point& c) {
+  double detleft = (a.x - c.x) * (b.y - c.y);
+  double detright = (a.y - c.y) * (b.x - c.x);
+  double det = detleft - detright;
+  double detsum = 0;
+
+  if (detleft > 0) {
+    if (detright <= 0) {
+      return det;
+    }
+    detsum = detleft + detright;
+  } else if (detleft < 0) {
+    if (detright >= 0) {
+      return det;
+    }
+    detsum = -detleft - detright;
+  } else {
+    return det;
+  }
+
+  double errbound = predicates::kCcwErrBoundA * detsum;
+  if (det >= errbound || -det >= errbound) {
+    return det;
+  }
+
+  return predicates::orient2d_adapt(a, b, c, detsum);
+}
+
+// > 0, если d лежит внутри окружности через a, b, c (заданных против
+// часовой стрелки), < 0 - снаружи, 0 - точно на окружности.
+inline double incircle(const Point& a, const Point& b, const Point& c,
+                       const Point& d) {
+  double adx = a.x - d.x;
+  double bdx = b.x - d.x;
+  double cdx = c.x - d.x;
+  double ady = a.y - d.y;
+  double bdy = b.y - d.y;
+  double cdy = c.y - d.y;
+
+  double bdxcdy = bdx * cdy;
+  double cdxbdy = cdx * bdy;
+  double alift = adx * adx + ady * ady;
+
+  double cdxady = cdx * ady;
+  double adxcdy = adx * cdy;
+  double blift = bdx * bdx + bdy * bdy;
+
+  double adxbdy = adx * bdy;
+  double bdxady = bdx * ady;
+  double clift = cdx * cdx + cdy * cdy;
+
+  double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+               clift * (adxbdy - bdxady);
+
+  double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift +
+                     (std::abs(cdxady) + std::abs(adxcdy)) * blift +
+                     (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+  double errbound = predicates::kIccErrBoundA * permanent;
+  if (det > errbound || -det > errbound) {
+    return det;
+  }
+
+  return predicates::incircle_exact(a, b, c, d);
+}
+
+// Для остальных скалярных типов координаты переводятся в double: для float
+// и int32 это точно, так что знак остаётся точным.
+template <typename T>
+double orient2d(const BasicPoint<T>& a, const BasicPoint<T>& b,
+                const BasicPoint<T>& c) {
+  return orient2d(Point(a.x, a.y), Point(b.x, b.y), Point(c.x, c.y));
+}
+
+template <typename T>
+double incircle(const BasicPoint<T>& a, const BasicPoint<T>& b,
+                const BasicPoint<T>& c, const BasicPoint<T>& d) {
+  return incircle(Point(a.x, a.y), Point(b.x, b.y), Point(c.x, c.y),
+                  Point(d.x, d.y));
+}
+
+// |sin| угла между векторами из начала координат в a и b не больше
+// точности типа; в отличие от сравнения произведений не зависит от масштаба
+template <typename T>
+bool collinear(const BasicPoint<T>& a, const BasicPoint<T>& b) {
+  double cross = orient2d(BasicPoint<T>(0, 0), a, b);
+  if (cross == 0) {
+    return true;
+  }
+  return std::abs(cross) <= scalar_traits<T>::accuracy *
+                                std::hypot(double(a.x), double(a.y)) *
+                                std::hypot(double(b.x), double(b.y));
+}
+}  // namespace my
+
+namespace my {
+template <typename T>
+class BasicVector {
  public:
-  double x_coord;
-  double y_coord;
+  using traits = scalar_traits<T>;
+  using real = typename traits::real_type;
+
+  T x_coord;
+  T y_coord;
 
-  Vector(double x, double y) : x_coord(x), y_coord(y) {}
+  BasicVector(T x, T y) : x_coord(x), y_coord(y) {}
 
-  Vector(const Point& first, const Point& second)
+  BasicVector(const BasicPoint<T>& first, const BasicPoint<T>& second)
       : x_coord(second.x - first.x), y_coord(second.y - first.y) {}
 
-  Vector(const Point& point) : x_coord(point.x), y_coord(point.y) {}
+  BasicVector(const BasicPoint<T>& point)
+      : x_coord(point.x), y_coord(point.y) {}
 
-  Vector(const Vector& other) = default;
+  BasicVector(const BasicVector& other) = default;
 
-  Vector rotated(double angle) const {
-    return Vector(std::cos(angle) * x_coord - std::sin(angle) * y_coord,
-                  std::cos(angle) * y_coord + std::sin(angle) * x_coord);
+  BasicVector& operator=(const BasicVector& other) = default;
+
+  BasicVector rotated(real angle) const {
+    return BasicVector(traits::from_real(std::cos(angle) * x_coord -
+                                         std::sin(angle) * y_coord),
+                       traits::from_real(std::cos(angle) * y_coord +
+                                         std::sin(angle) * x_coord));
   }
 
-  double abs() const {
-    return std::sqrt(std::pow(x_coord, 2) + std::pow(y_coord, 2));
+  real abs() const {
+    return std::sqrt(std::pow(real(x_coord), 2) + std::pow(real(y_coord), 2));
   }
 
-  Vector operator*(double k) const {
-    return Vector(x_coord * k, y_coord * k);
+  BasicVector operator*(real k) const {
+    return BasicVector(traits::from_real(x_coord * k),
+                       traits::from_real(y_coord * k));
   }
 
-  Vector operator-() const {
-    return Vector(-x_coord, -y_coord);
+  BasicVector operator-() const {
+    return BasicVector(-x_coord, -y_coord);
   }
 
-  Vector operator+(const Vector& other) const {
-    return Vector(x_coord + other.x_coord, y_coord + other.y_coord);
+  BasicVector operator+(const BasicVector& other) const {
+    return BasicVector(x_coord + other.x_coord, y_coord + other.y_coord);
   }
 
-  Vector operator-(const Vector& other) const {
+  BasicVector operator-(const BasicVector& other) const {
     return *this + (-other);
   }
 
-  Vector& operator*=(double k) {
-    x_coord *= k;
-    y_coord *= k;
-    return *this;
+  BasicVector& operator*=(real k) {
+    return *this = *this * k;
   }
 
-  bool is_collinear(const Vector& other) const {
-    return my::double_equal(x_coord * other.y_coord, y_coord * other.x_coord);
+  bool is_collinear(const BasicVector& other) const {
+    return my::collinear(BasicPoint<T>(x_coord, y_coord),
+                         BasicPoint<T>(other.x_coord, other.y_coord));
   }
 
-  Vector normed() const {
+  BasicVector normed() const {
     return *this * (1. / abs());
   }
 
-  bool operator==(const Vector& other) const {
-    return is_collinear(other) && my::double_equal(other.abs(), abs());
+  bool operator==(const BasicVector& other) const {
+    return is_collinear(other) &&
+           scalar_traits<real>::equal(other.abs(), abs());
   }
 
-  bool operator!=(const Vector& other) const {
+  bool operator!=(const BasicVector& other) const {
     return !(*this == other);
   }
 };
 
-double ScalarProduct(const Vector& first, const Vector& second) {
-  return first.x_coord * second.x_coord + first.y_coord * second.y_coord;
-}
+using Vector = BasicVector<double>;
+
+template <typename T>
+typename scalar_traits<T>::real_type ScalarProduct(
+    const BasicVector<T>& first, const BasicVector<T>& second) {
+  using real = typename scalar_traits<T>::real_type;
+  return real(first.x_coord) * second.x_coord +
+         real(first.y_coord) * second.y_coord;
 }
+}  // namespace my
 
-class Line {
+template <typename T>
+class BasicLine {
  public:
-  Point point;
-  my::Vector dir;
+  using traits = my::scalar_traits<T>;
+  using real = typename traits::real_type;
+
+  BasicPoint<T> point;
+  my::BasicVector<T> dir;
 
-  Line(const Point& first, const Point& second)
-      : point(first), dir(my::Vector(first, second)) {}
+  BasicLine(const BasicPoint<T>& first, const BasicPoint<T>& second)
+      : point(first), dir(my::BasicVector<T>(first, second)) {}
 
-  Line(double k, double b_)
-      : point(Point(0, b_)),
-        dir(my::Vector(std::cos(std::atan(k)), std::sin(std::atan(k)))) {}
+  BasicLine(real k, real b_)
+      : point(BasicPoint<T>(0, traits::from_real(b_))),
+        dir(my::BasicVector<T>(traits::from_real(std::cos(std::atan(k))),
+                               traits::from_real(std::sin(std::atan(k))))) {}
 
-  Line(const Point& point, double k)
+  BasicLine(const BasicPoint<T>& point, real k)
       : point(point),
-        dir(my::Vector(std::cos(std::atan(k)), std::sin(std::atan(k)))) {}
+        dir(my::BasicVector<T>(traits::from_real(std::cos(std::atan(k))),
+                               traits::from_real(std::sin(std::atan(k))))) {}
 
-  Line(const Point& point, const my::Vector& vec) : point(point), dir(vec) {}
+  BasicLine(const BasicPoint<T>& point, const my::BasicVector<T>& vec)
+      : point(point), dir(vec) {}
 
-  bool operator==(const Line& other) const {
-    return my::Vector(point, other.point).is_collinear(dir) &&
+  bool operator==(const BasicLine& other) const {
+    return my::BasicVector<T>(point, other.point).is_collinear(dir) &&
            dir.is_collinear(other.dir);
   }
 
-  bool operator!=(const Line& other) const {
+  bool operator!=(const BasicLine& other) const {
     return !(*this == other);
   }
 };
 
-Point operator+(const Point& point, const my::Vector& vec) {
-  return Point(point.x + vec.x_coord, point.y + vec.y_coord);
+using Line = BasicLine<double>;
+
+template <typename T>
+struct BasicSegment {
+  BasicPoint<T> first;
+  BasicPoint<T> second;
+
+  BasicSegment(const BasicPoint<T>& first, const BasicPoint<T>& second)
+      : first(first), second(second) {}
+};
+
+using Segment = BasicSegment<double>;
+
+template <typename T>
+BasicPoint<T> operator+(const BasicPoint<T>& point,
+                        const my::BasicVector<T>& vec) {
+  return BasicPoint<T>(point.x + vec.x_coord, point.y + vec.y_coord);
 }
 
-Point Point::symmetrical(const Line& line) const {
-  my::Vector r1 = *this;
-  my::Vector r0 = line.point;
-  my::Vector projection = line.dir * my::ScalarProduct(line.dir, r1 - r0) *
-                          (1 / (line.dir.abs() * line.dir.abs()));
-  my::Vector ans = r1 - (r1 - r0 - projection) * 2;
-  return Point(0, 0) + ans;
+template <typename T>
+BasicPoint<T> BasicPoint<T>::symmetrical(const BasicLine<T>& line) const {
+  my::BasicVector<T> r1 = *this;
+  my::BasicVector<T> r0 = line.point;
+  my::BasicVector<T> projection =
+      line.dir * my::ScalarProduct(line.dir, r1 - r0) *
+      (1 / (line.dir.abs() * line.dir.abs()));
+  my::BasicVector<T> ans = r1 - (r1 - r0 - projection) * 2;
+  return BasicPoint<T>(0, 0) + ans;
 }
 
-Point::Point(const my::Vector& other) : x(other.x_coord), y(other.y_coord) {}
+template <typename T>
+BasicPoint<T>::BasicPoint(const my::BasicVector<T>& other)
+    : x(other.x_coord), y(other.y_coord) {}
+
+namespace my {
+// Оси координат параллельны сторонам; границы входят.
+template <typename real>
+struct BoundingBox {
+  real min_x = 0;
+  real min_y = 0;
+  real max_x = 0;
+  real max_y = 0;
+
+  template <typename T>
+  bool contains(const BasicPoint<T>& point) const {
+    return min_x <= point.x && point.x <= max_x && min_y <= point.y &&
+           point.y <= max_y;
+  }
+};
+}  // namespace my
 
-class Shape {
+template <typename T>
+class BasicCircle;
+
+template <typename T>
+class BasicShape {
  public:
-  virtual double perimeter() const = 0;
+  using real = typename my::scalar_traits<T>::real_type;
+
+  virtual real perimeter() const = 0;
 
-  virtual double area() const = 0;
+  virtual real area() const = 0;
 
-  virtual bool operator==(const Shape&) const = 0;
+  virtual bool operator==(const BasicShape&) const = 0;
 
-  bool operator!=(const Shape& other) const {
+  bool operator!=(const BasicShape& other) const {
     return !(*this == other);
   }
 
-  bool isCongruentTo(const Shape&) const;
+  bool isCongruentTo(const BasicShape&) const;
+
+  bool isSimilarTo(const BasicShape&) const;
 
-  bool isSimilarTo(const Shape&) const;
+  virtual bool containsPoint(const BasicPoint<T>&) const = 0;
 
-  virtual bool containsPoint(const Point&) const = 0;
+  virtual void rotate(const BasicPoint<T>&, real) = 0;
 
-  virtual void rotate(const Point&, double) = 0;
+  virtual void reflect(const BasicPoint<T>&) = 0;
 
-  virtual void reflect(const Point&) = 0;
+  virtual void reflect(const BasicLine<T>&) = 0;
 
-  virtual void reflect(const Line&) = 0;
+  virtual void scale(const BasicPoint<T>&, real) = 0;
 
-  virtual void scale(const Point&, double) = 0;
+  // Дешёвые оболочки для отсева: точка вне них фигуре не принадлежит.
+  virtual my::BoundingBox<real> boundingBox() const = 0;
 
-  virtual ~Shape() {}
+  virtual BasicCircle<T> boundingCircle() const = 0;
+
+  virtual ~BasicShape() {}
 };
 
-class Ellipse : public Shape {
+using Shape = BasicShape<double>;
+
+namespace my {
+enum class Precision {
+  Fast,       // три члена ряда Гаусса-Куммера, без корней, для отсева
+  Ramanujan,  // первая формула Рамануджана, по умолчанию
+  Exact       // через арифметико-геометрическое среднее, до ulp
+};
+
+template <typename real>
+real ellipse_perimeter(real a, real b, Precision precision) {
+  switch (precision) {
+    case Precision::Fast: {
+      real h = std::pow((a - b) / (a + b), 2);
+      return M_PIf64x * (a + b) * (1 + h / 4 + h * h / 64);
+    }
+    case Precision::Ramanujan:
+      return M_PIf64x *
+             (3 * (a + b) - std::sqrt((3 * a + b) * (3 * b + a)));
+    case Precision::Exact: {
+      if (a < b) {
+        std::swap(a, b);
+      }
+      // Вырожденный эллипс - дважды пройденный отрезок, и АГМ(a, 0) = 0.
+      // При b < ulp(a) поправка ~(b / a)^2 log(a / b) к 4a меньше ulp.
+      if (b <= std::numeric_limits<real>::epsilon() * a) {
+        return 4 * a;
+      }
+
+      // P = 2pi / AGM(a, b) * (a^2 - sum 2^(n-1) c_n^2). АГМ сходится
+      // квадратично, но число шагов растёт с log(a / b), поэтому шаги
+      // идут до c < ulp(a), а не фиксированное число раз.
+      real a0 = a;
+      real sum = (a * a - b * b) / 2;
+      real power = 0.5;
+      for (real c = (a - b) / 2;
+           c > std::numeric_limits<real>::epsilon() * a; c = (a - b) / 2) {
+        real next_a = (a + b) / 2;
+        b = std::sqrt(a * b);
+        a = next_a;
+        power *= 2;
+        sum += power * c * c;
+      }
+      return 2 * M_PIf64x / a * (a0 * a0 - sum);
+    }
+  }
+  return 0;
+}
+
+// Пакетная форма по массивам полуосей: выбор формулы вынесен из цикла.
+// У Fast и Ramanujan тело цикла одинаково для всех элементов и
+// векторизуется; у Exact число шагов АГМ зависит от отношения полуосей,
+// так что этот цикл ветвится.
+template <typename real>
+void ellipse_perimeters(const real* a, const real* b, real* out, size_t count,
+                        Precision precision) {
+  switch (precision) {
+    case Precision::Fast:
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = ellipse_perimeter(a[i], b[i], Precision::Fast);
+      }
+      break;
+    case Precision::Ramanujan:
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = ellipse_perimeter(a[i], b[i], Precision::Ramanujan);
+      }
+      break;
+    case Precision::Exact:
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = ellipse_perimeter(a[i], b[i], Precision::Exact);
+      }
+      break;
+  }
+}
+}  // namespace my
+
+template <typename T>
+class BasicEllipse : public BasicShape<T> {
+ public:
+  using real = typename BasicShape<T>::real;
+
  private:
-  Point F1_;
-  Point F2_;
-  double a_;
-  double b_;
+  using real_traits = my::scalar_traits<real>;
+
+  BasicPoint<T> F1_;
+  BasicPoint<T> F2_;
+  real a_;
+  real b_;
+  // зависят только от фокусов и полуосей, пересчитываются при их изменении
+  real e_;
+  BasicPoint<T> center_point_;
+
+  void update_cache() {
+    e_ = std::sqrt(1 - std::pow(b_ / a_, 2));
+    center_point_ = F1_ + my::BasicVector<T>(F1_, F2_) * (1. / 2);
+  }
 
  public:
-  Ellipse(const Point& F1_, const Point& F2_, double len)
+  BasicEllipse(const BasicPoint<T>& F1_, const BasicPoint<T>& F2_, real len)
       : F1_(F1_),
         F2_(F2_),
         a_(len / 2),
-        b_(std::sqrt(std::pow(len, 2) - std::pow(F1_.distance(F2_), 2)) / 2) {}
+        b_(std::sqrt(std::pow(len, 2) - std::pow(F1_.distance(F2_), 2)) / 2) {
+    update_cache();
+  }
 
-  std::pair<Point, Point> focuses() const {
+  std::pair<BasicPoint<T>, BasicPoint<T>> focuses() const {
     return std::make_pair(F1_, F2_);
   }
 
-  double eccentricity() const {
-    return std::sqrt(1 - std::pow(b_ / a_, 2));
+  real semiMajorAxis() const {
+    return a_;
   }
 
-  Point center_() const {
-    my::Vector F1_F2_dir = my::Vector(F1_, F2_);
-
-    return F1_ + F1_F2_dir * (1. / 2);
+  real semiMinorAxis() const {
+    return b_;
   }
 
-  std::pair<Line, Line> directrices() const {
-    double e = eccentricity();
+  real eccentricity() const {
+    return e_;
+  }
 
-    my::Vector F1_F2_dir = my::Vector(F1_, F2_);
-    my::Vector d_dir = my::Vector(-F1_F2_dir.y_coord, F1_F2_dir.x_coord);
+  BasicPoint<T> center_() const {
+    return center_point_;
+  }
 
-    Point d1_point = center_() + F1_F2_dir.normed() * (a_ / e);
-    Point d2_point = center_() + -F1_F2_dir.normed() * (a_ / e);
+  std::pair<BasicLine<T>, BasicLine<T>> directrices() const {
+    my::BasicVector<T> F1_F2_dir = my::BasicVector<T>(F1_, F2_);
+    my::BasicVector<T> d_dir =
+        my::BasicVector<T>(-F1_F2_dir.y_coord, F1_F2_dir.x_coord);
+    my::BasicVector<T> shift = F1_F2_dir.normed() * (a_ / e_);
 
-    Line d1(d1_point, d_dir);
-    Line d2(d2_point, d_dir);
+    BasicLine<T> d1(center_point_ + shift, d_dir);
+    BasicLine<T> d2(center_point_ + -shift, d_dir);
 
     return std::make_pair(d1, d2);
   }
 
-  double perimeter() const final {
-    return M_PIf64x *
-           (3 * (a_ + b_) - std::sqrt((3 * a_ + b_) * (3 * b_ + a_)));
+  real perimeter() const final {
+    return my::ellipse_perimeter(a_, b_, my::Precision::Ramanujan);
   }
 
-  double area() const final {
+  real perimeter(my::Precision precision) const {
+    return my::ellipse_perimeter(a_, b_, precision);
+  }
+
+  real area() const final {
     return M_PIf64x * a_ * b_;
   }
 
-  bool containsPoint(const Point& point) const final {
-    return F1_.distance(point) + F2_.distance(point) <= 2 * a_ + my::kAccuracy;
+  bool containsPoint(const BasicPoint<T>& point) const final {
+    // вне описанного круга радиуса a - без двух корней
+    real dx = real(point.x) - (real(F1_.x) + F2_.x) / 2;
+    real dy = real(point.y) - (real(F1_.y) + F2_.y) / 2;
+    real reach = a_ + real_traits::accuracy;
+    if (dx * dx + dy * dy > reach * reach) {
+      return false;
+    }
+    return F1_.distance(point) + F2_.distance(point) <=
+           2 * a_ + real_traits::accuracy;
+  }
+
+  // Полуширины - опорные функции эллипса, повёрнутого на угол F1F2.
+  // containsPoint принимает d1 + d2 <= 2a + accuracy, то есть софокусный
+  // эллипс с полуосями a + accuracy / 2 и sqrt(b^2 + a accuracy + ...):
+  // у тонкого эллипса вторая на порядки больше b, поэтому коробка - по нему.
+  my::BoundingBox<real> boundingBox() const final {
+    real cx = (real(F1_.x) + F2_.x) / 2;
+    real cy = (real(F1_.y) + F2_.y) / 2;
+    real angle = std::atan2(real(F2_.y) - F1_.y, real(F2_.x) - F1_.x);
+    real a = a_ + real_traits::accuracy / 2;
+    real b = std::sqrt(b_ * b_ + (a - a_) * (a + a_));
+    real half_w = std::hypot(a * std::cos(angle), b * std::sin(angle));
+    real half_h = std::hypot(a * std::sin(angle), b * std::cos(angle));
+    return {cx - half_w, cy - half_h, cx + half_w, cy + half_h};
   }
 
-  void rotate(const Point& point, double angle) final {
-    F1_ = point + my::Vector(point, F1_).rotated(angle);
-    F2_ = point + my::Vector(point, F2_).rotated(angle);
+  BasicCircle<T> boundingCircle() const final;
+
+  void rotate(const BasicPoint<T>& point, real angle) final {
+    F1_ = point + my::BasicVector<T>(point, F1_).rotated(angle);
+    F2_ = point + my::BasicVector<T>(point, F2_).rotated(angle);
+    update_cache();
   }
 
-  void reflect(const Point& point) final {
-    F1_ = point + -my::Vector(point, F1_);
-    F2_ = point + -my::Vector(point, F2_);
+  void reflect(const BasicPoint<T>& point) final {
+    F1_ = point + -my::BasicVector<T>(point, F1_);
+    F2_ = point + -my::BasicVector<T>(point, F2_);
+    update_cache();
   }
 
-  void reflect(const Line& line) final {
+  void reflect(const BasicLine<T>& line) final {
     F1_ = F1_.symmetrical(line);
     F2_ = F2_.symmetrical(line);
+    update_cache();
   }
 
-  void scale(const Point& point, double coef) final {
-    F1_ = point + my::Vector(point, F1_) * coef;
-    F2_ = point + my::Vector(point, F2_) * coef;
+  void scale(const BasicPoint<T>& point, real coef) final {
+    F1_ = point + my::BasicVector<T>(point, F1_) * coef;
+    F2_ = point + my::BasicVector<T>(point, F2_) * coef;
     a_ *= std::abs(coef);
     b_ *= std::abs(coef);
+    update_cache();
   }
 
-  bool operator==(const Shape& other) const final {
-    const Ellipse* cnt_other = dynamic_cast<const Ellipse*>(&other);
+  bool operator==(const BasicShape<T>& other) const final {
+    const BasicEllipse* cnt_other = dynamic_cast<const BasicEllipse*>(&other);
 
     if (cnt_other != nullptr) {
       auto this_focuses = focuses();
@@ -269,97 +879,780 @@ class Ellipse : public Shape {
                    this_focuses.second),  // офигеть я чё придумал, запятую
                                           // использовал первый раз
                this_focuses) == other_focuses) &&
-             my::double_equal(eccentricity(), cnt_other->eccentricity());
+             real_traits::equal(eccentricity(), cnt_other->eccentricity());
     }
     return false;
   }
 };
 
-class Circle : public Shape {
+using Ellipse = BasicEllipse<double>;
+
+namespace my {
+template <typename T>
+std::vector<typename BasicEllipse<T>::real> ellipse_perimeters(
+    const std::vector<BasicEllipse<T>>& ellipses, Precision precision) {
+  using real = typename BasicEllipse<T>::real;
+
+  std::vector<real> a(ellipses.size());
+  std::vector<real> b(ellipses.size());
+  for (size_t i = 0; i < ellipses.size(); ++i) {
+    a[i] = ellipses[i].semiMajorAxis();
+    b[i] = ellipses[i].semiMinorAxis();
+  }
+
+  std::vector<real> ans(ellipses.size());
+  ellipse_perimeters(a.data(), b.data(), ans.data(), ans.size(), precision);
+  return ans;
+}
+}  // namespace my
+
+template <typename T>
+class BasicCircle : public BasicShape<T> {
+ public:
+  using real = typename BasicShape<T>::real;
+
  private:
-  Point center_;
-  double r_;
+  using real_traits = my::scalar_traits<real>;
+
+  BasicPoint<T> center_;
+  real r_;
 
  public:
-  Circle(const Point& point, double r_) : center_(point), r_(r_) {}
+  BasicCircle(const BasicPoint<T>& point, real r_) : center_(point), r_(r_) {}
 
-  Point center() const {
+  BasicPoint<T> center() const {
     return center_;
   }
 
-  double radius() const {
+  real radius() const {
     return r_;
   }
 
-  double perimeter() const final {
+  real perimeter() const final {
     return 2 * M_PIf64x * r_;
   }
 
-  double area() const final {
+  real area() const final {
     return M_PIf64x * std::pow(r_, 2);
   }
 
-  bool containsPoint(const Point& point) const final {
-    return center_.distance(point) <= r_ + my::kAccuracy;
+  bool containsPoint(const BasicPoint<T>& point) const final {
+    return center_.distance(point) <= r_ + real_traits::accuracy;
+  }
+
+  my::BoundingBox<real> boundingBox() const final {
+    return {center_.x - r_, center_.y - r_, center_.x + r_, center_.y + r_};
+  }
+
+  BasicCircle boundingCircle() const final {
+    return *this;
   }
 
-  void rotate(const Point& point, double angle) final {
-    center_ = point + my::Vector(point, center_).rotated(angle);
+  void rotate(const BasicPoint<T>& point, real angle) final {
+    center_ = point + my::BasicVector<T>(point, center_).rotated(angle);
   }
 
-  void reflect(const Point& point) final {
-    center_ = point + -my::Vector(point, center_);
+  void reflect(const BasicPoint<T>& point) final {
+    center_ = point + -my::BasicVector<T>(point, center_);
   }
 
-  void reflect(const Line& line) final {
+  void reflect(const BasicLine<T>& line) final {
     center_ = center_.symmetrical(line);
   }
 
-  void scale(const Point& point, double coef) final {
-    center_ = point + my::Vector(point, center_) * coef;
+  void scale(const BasicPoint<T>& point, real coef) final {
+    center_ = point + my::BasicVector<T>(point, center_) * coef;
     r_ *= std::abs(coef);
   }
 
-  bool operator==(const Shape& other) const final {
-    const Circle* cnt_other = dynamic_cast<const Circle*>(&other);
+  bool operator==(const BasicShape<T>& other) const final {
+    const BasicCircle* cnt_other = dynamic_cast<const BasicCircle*>(&other);
 
     if (cnt_other != nullptr) {
       return center_ == cnt_other->center_ &&
-             my::double_equal(r_, cnt_other->r_);
+             real_traits::equal(r_, cnt_other->r_);
     }
     return false;
   }
 };
 
-class Polygon : public Shape {
+using Circle = BasicCircle<double>;
+
+namespace my {
+namespace detail {
+template <typename real>
+struct Disk {
+  real x;
+  real y;
+  real r;
+
+  template <typename T>
+  bool contains(const BasicPoint<T>& point) const {
+    real dx = real(point.x) - x;
+    real dy = real(point.y) - y;
+    return std::sqrt(dx * dx + dy * dy) <=
+           r * (1 + 64 * std::numeric_limits<real>::epsilon());
+  }
+};
+
+template <typename real, typename T>
+Disk<real> disk(const BasicPoint<T>& a, const BasicPoint<T>& b) {
+  return {(real(a.x) + b.x) / 2, (real(a.y) + b.y) / 2, a.distance(b) / 2};
+}
+
+// окружность через три точки; на одной прямой - по самой далёкой паре
+template <typename real, typename T>
+Disk<real> disk(const BasicPoint<T>& a, const BasicPoint<T>& b,
+                const BasicPoint<T>& c) {
+  if (orient2d(a, b, c) == 0) {
+    Disk<real> ans = disk<real>(a, b);
+    for (const Disk<real>& cnt : {disk<real>(a, c), disk<real>(b, c)}) {
+      if (cnt.r > ans.r) {
+        ans = cnt;
+      }
+    }
+    return ans;
+  }
+  real bx = real(b.x) - a.x;
+  real by = real(b.y) - a.y;
+  real cx = real(c.x) - a.x;
+  real cy = real(c.y) - a.y;
+  real b_len2 = bx * bx + by * by;
+  real c_len2 = cx * cx + cy * cy;
+  real cross = 2 * (bx * cy - by * cx);
+  real ux = (cy * b_len2 - by * c_len2) / cross;
+  real uy = (bx * c_len2 - cx * b_len2) / cross;
+  return {a.x + ux, a.y + uy, std::sqrt(ux * ux + uy * uy)};
+}
+
+// Велцль в итеративной форме: после перемешивания точка выходит за текущий
+// круг с вероятностью не больше 3 / i, поэтому ожидаемое время O(n).
+template <typename T>
+Disk<typename scalar_traits<T>::real_type> enclosing_disk(
+    std::vector<BasicPoint<T>> points) {
+  using real = typename scalar_traits<T>::real_type;
+  if (points.empty()) {
+    throw std::invalid_argument("min_enclosing_circle: no points");
+  }
+  std::shuffle(points.begin(), points.end(), std::mt19937(points.size()));
+
+  Disk<real> ans{real(points[0].x), real(points[0].y), 0};
+  for (size_t i = 1; i < points.size(); ++i) {
+    if (ans.contains(points[i])) {
+      continue;
+    }
+    ans = {real(points[i].x), real(points[i].y), 0};
+    for (size_t j = 0; j < i; ++j) {
+      if (ans.contains(points[j])) {
+        continue;
+      }
+      ans = disk<real>(points[i], points[j]);
+      for (size_t k = 0; k < j; ++k) {
+        if (!ans.contains(points[k])) {
+          ans = disk<real>(points[i], points[j], points[k]);
+        }
+      }
+    }
+  }
+  return ans;
+}
+
+// для целых центр округляется, радиус растёт на сдвиг центра
+template <typename T, typename real>
+BasicCircle<T> to_circle(const Disk<real>& disk) {
+  BasicPoint<T> center(scalar_traits<T>::from_real(disk.x),
+                       scalar_traits<T>::from_real(disk.y));
+  return BasicCircle<T>(
+      center, disk.r + std::hypot(center.x - disk.x, center.y - disk.y));
+}
+}  // namespace detail
+
+template <typename T>
+BasicCircle<T> min_enclosing_circle(const std::vector<BasicPoint<T>>& points) {
+  return detail::to_circle<T>(detail::enclosing_disk(points));
+}
+}  // namespace my
+
+template <typename T>
+BasicCircle<T> BasicEllipse<T>::boundingCircle() const {
+  return my::detail::to_circle<T>(my::detail::Disk<real>{
+      (real(F1_.x) + F2_.x) / 2, (real(F1_.y) + F2_.y) / 2, a_});
+}
+
+namespace my {
+// Вершины многоугольника структурой массивов: x[] и y[] лежат отдельно, а в
+// конце продублирована первая вершина. Поэтому ребро i -> i + 1 есть для
+// всех i < size(), и циклы идут подряд по памяти без % и ветвлений.
+template <typename T>
+class SoAVertices {
+ public:
+  using real = typename scalar_traits<T>::real_type;
+
+ private:
+  using traits = scalar_traits<T>;
+
+  // число независимых сумм: без них компилятор не может переставлять
+  // сложения и не векторизует редукцию
+  static constexpr size_t kLanes = 8;
+
+  std::vector<T> xs_;
+  std::vector<T> ys_;
+
+  template <typename Func>
+  real reduce_edges(Func edge) const {
+    real acc[kLanes] = {};
+    size_t n = size();
+    size_t i = 0;
+
+    for (; i + kLanes <= n; i += kLanes) {
+      for (size_t lane = 0; lane < kLanes; ++lane) {
+        acc[lane] += edge(i + lane);
+      }
+    }
+    for (; i < n; ++i) {
+      acc[0] += edge(i);
+    }
+
+    real ans = 0;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      ans += acc[lane];
+    }
+    return ans;
+  }
+
+  bool robust_contains(const BasicPoint<T>& point) const {
+    bool result = false;
+
+    for (size_t i = 0; i < size(); ++i) {
+      BasicPoint<T> cnt(xs_[i], ys_[i]);
+      BasicPoint<T> next(xs_[i + 1], ys_[i + 1]);
+      double orientation = orient2d(cnt, next, point);
+
+      if (orientation == 0 && std::min(cnt.x, next.x) <= point.x &&
+          point.x <= std::max(cnt.x, next.x) &&
+          std::min(cnt.y, next.y) <= point.y &&
+          point.y <= std::max(cnt.y, next.y)) {
+        return true;
+      }
+
+      if ((cnt.y < point.y && next.y >= point.y && orientation < 0) ||
+          (next.y < point.y && cnt.y >= point.y && orientation > 0)) {
+        result = !result;
+      }
+    }
+
+    return result;
+  }
+
+ public:
+  SoAVertices() = default;
+
+  explicit SoAVertices(const std::vector<BasicPoint<T>>& points) {
+    xs_.reserve(points.size() + 1);
+    ys_.reserve(points.size() + 1);
+    for (const auto& point : points) {
+      xs_.push_back(point.x);
+      ys_.push_back(point.y);
+    }
+    if (!points.empty()) {
+      xs_.push_back(points[0].x);
+      ys_.push_back(points[0].y);
+    }
+  }
+
+  size_t size() const {
+    return xs_.empty() ? 0 : xs_.size() - 1;
+  }
+
+  // size() + 1 элементов, последний совпадает с первым
+  const T* x() const {
+    return xs_.data();
+  }
+
+  const T* y() const {
+    return ys_.data();
+  }
+
+  BasicPoint<T> operator[](size_t i) const {
+    return BasicPoint<T>(xs_[i], ys_[i]);
+  }
+
+  std::vector<BasicPoint<T>> points() const {
+    std::vector<BasicPoint<T>> ans;
+    ans.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+      ans.emplace_back(xs_[i], ys_[i]);
+    }
+    return ans;
+  }
+
+  real area() const {
+    const T* x = xs_.data();
+    const T* y = ys_.data();
+    real ans = reduce_edges([x, y](size_t i) {
+      return real(x[i]) * real(y[i + 1]) - real(x[i + 1]) * real(y[i]);
+    });
+    return std::abs(ans / 2);
+  }
+
+  real perimeter() const {
+    const T* x = xs_.data();
+    const T* y = ys_.data();
+    return reduce_edges([x, y](size_t i) {
+      real dx = real(x[i + 1]) - real(x[i]);
+      real dy = real(y[i + 1]) - real(y[i]);
+      return std::sqrt(dx * dx + dy * dy);
+    });
+  }
+
+  // Быстрый проход считает ориентацию с фильтром ошибки из orient2d. Если
+  // хоть одно ребро попало в зону неуверенности (в том числе точка на
+  // границе), ответ пересчитывается точными предикатами.
+  bool containsPoint(const BasicPoint<T>& point) const {
+    const T* x = xs_.data();
+    const T* y = ys_.data();
+    double px = point.x;
+    double py = point.y;
+    unsigned crossings = 0;
+    unsigned uncertain = 0;
+
+    for (size_t i = 0; i < size(); ++i) {
+      double ax = x[i];
+      double ay = y[i];
+      double bx = x[i + 1];
+      double by = y[i + 1];
+
+      double detleft = (ax - px) * (by - py);
+      double detright = (ay - py) * (bx - px);
+      double det = detleft - detright;
+      double errbound = predicates::kCcwErrBoundA *
+                        (std::abs(detleft) + std::abs(detright));
+
+      unsigned up = (ay < py) & (by >= py) & (det < 0);
+      unsigned down = (by < py) & (ay >= py) & (det > 0);
+      crossings ^= up | down;
+      uncertain |= std::abs(det) <= errbound;
+    }
+
+    if (uncertain != 0) {
+      return robust_contains(point);
+    }
+    return crossings != 0;
+  }
+
+  void rotate(const BasicPoint<T>& point, real angle) {
+    real cos_a = std::cos(angle);
+    real sin_a = std::sin(angle);
+    real cx = point.x;
+    real cy = point.y;
+    T* x = xs_.data();
+    T* y = ys_.data();
+
+    for (size_t i = 0; i < xs_.size(); ++i) {
+      real dx = real(x[i]) - cx;
+      real dy = real(y[i]) - cy;
+      x[i] = traits::from_real(cx + (cos_a * dx - sin_a * dy));
+      y[i] = traits::from_real(cy + (cos_a * dy + sin_a * dx));
+    }
+  }
+
+  void scale(const BasicPoint<T>& point, real coef) {
+    real cx = point.x;
+    real cy = point.y;
+    T* x = xs_.data();
+    T* y = ys_.data();
+
+    for (size_t i = 0; i < xs_.size(); ++i) {
+      x[i] = traits::from_real(cx + (real(x[i]) - cx) * coef);
+      y[i] = traits::from_real(cy + (real(y[i]) - cy) * coef);
+    }
+  }
+};
+}  // namespace my
+
+// Пересечения отрезков заметающей прямой (Бентли - Оттман), O((n + k) log n).
+// Все решения принимаются точными предикатами: точки пересечения хранятся
+// дробями из разложений, поэтому порядок на прямой не ломается на касаниях,
+// общих концах и наложениях.
+namespace my {
+namespace detail {
+// Событие (x / w, y / w), w > 0. Концы отрезков лежат в point как есть, у
+// точек пересечения point - только приближение для быстрого сравнения.
+struct SweepPoint {
+  Point point;
+  bool exact = true;
+  predicates::Expansion x;
+  predicates::Expansion y;
+  predicates::Expansion w;
+
+  explicit SweepPoint(const Point& point) : point(point) {}
+};
+
+inline double approximate(const predicates::Expansion& e) {
+  double ans = 0;
+  for (double elem : e) {
+    ans += elem;
+  }
+  return ans;
+}
+
+// знак разности координат событий
+inline double compare_coord(const SweepPoint& a, const SweepPoint& b,
+                            bool by_x) {
+  double first = by_x ? a.point.x : a.point.y;
+  double second = by_x ? b.point.x : b.point.y;
+  if (a.exact && b.exact) {
+    return first - second;
+  }
+  // у дроби относительная погрешность point порядка 1e-15
+  if (std::abs(first - second) >
+      1e-12 * (std::abs(first) + std::abs(second))) {
+    return first - second;
+  }
+
+  using predicates::Expansion;
+  Expansion first_num = a.exact ? Expansion{first} : (by_x ? a.x : a.y);
+  Expansion second_num = b.exact ? Expansion{second} : (by_x ? b.x : b.y);
+  Expansion first_w = a.exact ? Expansion{1} : a.w;
+  Expansion second_w = b.exact ? Expansion{1} : b.w;
+  return predicates::most_significant(
+      predicates::sum(predicates::product(first_num, second_w),
+                      predicates::negated(predicates::product(
+                          second_num, first_w))));
+}
+
+struct SweepPointLess {
+  bool operator()(const SweepPoint& a, const SweepPoint& b) const {
+    double dx = compare_coord(a, b, true);
+    return dx < 0 || (dx == 0 && compare_coord(a, b, false) < 0);
+  }
+};
+
+// знак orient2d(s.first, s.second, p) для события p
+inline double orient2d_event(const Segment& s, const SweepPoint& p) {
+  if (p.exact) {
+    return my::orient2d(s.first, s.second, p.point);
+  }
+  // фильтр: координаты приближения точны до нескольких ulp
+  double dx = s.second.x - s.first.x;
+  double dy = s.second.y - s.first.y;
+  double left = dx * (p.point.y - s.first.y);
+  double right = dy * (p.point.x - s.first.x);
+  double errbound = 1e-14 * (std::abs(left) + std::abs(right) +
+                             (std::abs(dx) + std::abs(dy)) *
+                                 (std::abs(p.point.x) + std::abs(p.point.y)));
+  if (std::abs(left - right) > errbound) {
+    return left - right;
+  }
+
+  using namespace predicates;
+  Expansion px = sum(p.x, negated(scale(p.w, s.first.x)));
+  Expansion py = sum(p.y, negated(scale(p.w, s.first.y)));
+  return most_significant(
+      sum(product(exact_diff(s.second.x, s.first.x), py),
+          negated(product(exact_diff(s.second.y, s.first.y), px))));
+}
+
+// знак векторного произведения направлений отрезков
+inline double direction_cross(const Segment& a, const Segment& b) {
+  if (a.first.x == b.first.x && a.first.y == b.first.y) {
+    return my::orient2d(a.first, a.second, b.second);
+  }
+  double left = (a.second.x - a.first.x) * (b.second.y - b.first.y);
+  double right = (a.second.y - a.first.y) * (b.second.x - b.first.x);
+  if (std::abs(left - right) > 1e-14 * (std::abs(left) + std::abs(right))) {
+    return left - right;
+  }
+
+  using namespace predicates;
+  return most_significant(
+      sum(product(exact_diff(a.second.x, a.first.x),
+                  exact_diff(b.second.y, b.first.y)),
+          negated(product(exact_diff(a.second.y, a.first.y),
+                          exact_diff(b.second.x, b.first.x)))));
+}
+
+// Точка пересечения a.first + (a.second - a.first) * N / D.
+inline SweepPoint crossing_point(const Segment& a, const Segment& b) {
+  using namespace predicates;
+  Expansion adx = exact_diff(a.second.x, a.first.x);
+  Expansion ady = exact_diff(a.second.y, a.first.y);
+  Expansion bdx = exact_diff(b.second.x, b.first.x);
+  Expansion bdy = exact_diff(b.second.y, b.first.y);
+  Expansion den = sum(product(adx, bdy), negated(product(ady, bdx)));
+  Expansion num = sum(product(exact_diff(b.first.x, a.first.x), bdy),
+                      negated(product(exact_diff(b.first.y, a.first.y), bdx)));
+  if (most_significant(den) < 0) {
+    den = negated(den);
+    num = negated(num);
+  }
+
+  SweepPoint ans(Point(0, 0));
+  ans.exact = false;
+  ans.x = sum(scale(den, a.first.x), product(adx, num));
+  ans.y = sum(scale(den, a.first.y), product(ady, num));
+  ans.w = std::move(den);
+  ans.point = Point(approximate(ans.x) / approximate(ans.w),
+                    approximate(ans.y) / approximate(ans.w));
+  return ans;
+}
+
+class SegmentSweep {
+ private:
+  // Порядок отрезков на заметающей прямой сразу после текущего события.
+  // Сравниваются только вставляемые (проходят через событие) с остальными,
+  // поэтому хватает положения события относительно отрезка и направлений.
+  struct StatusLess {
+    using is_transparent = void;
+
+    const SegmentSweep* sweep;
+
+    bool operator()(uint32_t a, uint32_t b) const {
+      bool a_new = sweep->stamp_[a] == sweep->event_;
+      bool b_new = sweep->stamp_[b] == sweep->event_;
+      if (a_new && b_new) {
+        double cross =
+            direction_cross(sweep->segments_[a], sweep->segments_[b]);
+        return cross != 0 ? cross > 0 : a < b;
+      }
+      if (a_new) {
+        return orient2d_event(sweep->segments_[b], *sweep->current_) < 0;
+      }
+      if (b_new) {
+        return orient2d_event(sweep->segments_[a], *sweep->current_) > 0;
+      }
+      return a < b;
+    }
+
+    bool operator()(uint32_t a, const SweepPoint& p) const {
+      return orient2d_event(sweep->segments_[a], p) > 0;
+    }
+
+    bool operator()(const SweepPoint& p, uint32_t a) const {
+      return orient2d_event(sweep->segments_[a], p) < 0;
+    }
+  };
+
+  std::vector<Segment> segments_;
+  std::vector<size_t> stamp_;
+  size_t event_ = 0;
+  const SweepPoint* current_ = nullptr;
+  std::map<SweepPoint, std::vector<uint32_t>, SweepPointLess> events_;
+  std::set<uint32_t, StatusLess> status_;
+
+  static bool less(const Point& a, const Point& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+
+  // Новое событие нужно только для пересечения во внутренних точках обоих
+  // отрезков: касание в конце и наложения приходятся на концы, а они уже
+  // в очереди.
+  void schedule(uint32_t first, uint32_t second) {
+    const Segment& a = segments_[first];
+    const Segment& b = segments_[second];
+    double o1 = my::orient2d(a.first, a.second, b.first);
+    double o2 = my::orient2d(a.first, a.second, b.second);
+    double o3 = my::orient2d(b.first, b.second, a.first);
+    double o4 = my::orient2d(b.first, b.second, a.second);
+    if (o1 == 0 || o2 == 0 || o3 == 0 || o4 == 0 || (o1 > 0) == (o2 > 0) ||
+        (o3 > 0) == (o4 > 0)) {
+      return;
+    }
+    SweepPoint point = crossing_point(a, b);
+    if (SweepPointLess()(*current_, point)) {
+      events_.try_emplace(std::move(point));
+    }
+  }
+
+ public:
+  template <typename T>
+  explicit SegmentSweep(const std::vector<BasicSegment<T>>& segments)
+      : stamp_(segments.size(), 0), status_(StatusLess{this}) {
+    segments_.reserve(segments.size());
+    for (uint32_t i = 0; i < segments.size(); ++i) {
+      Point first(segments[i].first.x, segments[i].first.y);
+      Point second(segments[i].second.x, segments[i].second.y);
+      if (less(second, first)) {
+        std::swap(first, second);
+      }
+      segments_.emplace_back(first, second);
+      events_[SweepPoint(first)].push_back(i);
+      events_.try_emplace(SweepPoint(second));
+    }
+  }
+
+  // func(i, j), i < j, для каждой пары отрезков в каждой их общей точке
+  // события; пара с наложением встречается несколько раз. true из func
+  // останавливает обход.
+  template <typename Func>
+  void run(Func func) {
+    std::vector<uint32_t> through;
+    std::vector<uint32_t> touching;
+
+    while (!events_.empty()) {
+      auto node = events_.extract(events_.begin());
+      const SweepPoint& point = node.key();
+      const std::vector<uint32_t>& starting = node.mapped();
+      current_ = &point;
+      ++event_;
+
+      auto [lo, hi] = status_.equal_range(point);
+      through.assign(lo, hi);
+      touching = through;
+      touching.insert(touching.end(), starting.begin(), starting.end());
+      for (size_t i = 0; i < touching.size(); ++i) {
+        for (size_t j = i + 1; j < touching.size(); ++j) {
+          if (func(std::min(touching[i], touching[j]),
+                   std::max(touching[i], touching[j]))) {
+            return;
+          }
+        }
+      }
+
+      // отрезки, проходящие через событие, вставляются заново в порядке
+      // после него, закончившиеся выбывают
+      status_.erase(lo, hi);
+      for (uint32_t id : through) {
+        const Point& end = segments_[id].second;
+        if (!point.exact || end.x != point.point.x ||
+            end.y != point.point.y) {
+          stamp_[id] = event_;
+          status_.insert(id);
+        }
+      }
+      for (uint32_t id : starting) {
+        const Segment& segment = segments_[id];
+        if (less(segment.first, segment.second)) {
+          stamp_[id] = event_;
+          status_.insert(id);
+        }
+      }
+
+      std::tie(lo, hi) = status_.equal_range(point);
+      if (lo == hi) {
+        if (lo != status_.begin() && hi != status_.end()) {
+          schedule(*std::prev(lo), *hi);
+        }
+        continue;
+      }
+      if (lo != status_.begin()) {
+        schedule(*std::prev(lo), *lo);
+      }
+      if (hi != status_.end()) {
+        schedule(*std::prev(hi), *hi);
+      }
+    }
+  }
+};
+}  // namespace detail
+
+// Общая точка у отрезков есть (включая концы и наложения).
+template <typename T>
+bool segments_intersect(const BasicSegment<T>& a, const BasicSegment<T>& b) {
+  double o1 = orient2d(a.first, a.second, b.first);
+  double o2 = orient2d(a.first, a.second, b.second);
+  double o3 = orient2d(b.first, b.second, a.first);
+  double o4 = orient2d(b.first, b.second, a.second);
+  if (o1 == 0 && o2 == 0 && o3 == 0 && o4 == 0) {
+    // на одной прямой: пересекаются проекции на обе оси
+    return std::max(std::min(a.first.x, a.second.x),
+                    std::min(b.first.x, b.second.x)) <=
+               std::min(std::max(a.first.x, a.second.x),
+                        std::max(b.first.x, b.second.x)) &&
+           std::max(std::min(a.first.y, a.second.y),
+                    std::min(b.first.y, b.second.y)) <=
+               std::min(std::max(a.first.y, a.second.y),
+                        std::max(b.first.y, b.second.y));
+  }
+  return !((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0) || (o3 > 0 && o4 > 0) ||
+           (o3 < 0 && o4 < 0));
+}
+
+// Вызывает func(i, j), i < j, для пересекающихся пар; наложенная пара может
+// прийти несколько раз. Если func вернула true, обход останавливается.
+template <typename T, typename Func>
+void for_each_intersection(const std::vector<BasicSegment<T>>& segments,
+                           Func func) {
+  detail::SegmentSweep(segments).run(func);
+}
+
+// Все пары (i, j), i < j, пересекающихся отрезков по возрастанию.
+template <typename T>
+std::vector<std::pair<size_t, size_t>> segment_intersections(
+    const std::vector<BasicSegment<T>>& segments) {
+  std::vector<std::pair<size_t, size_t>> ans;
+  for_each_intersection(segments, [&](size_t i, size_t j) {
+    ans.emplace_back(i, j);
+    return false;
+  });
+  std::sort(ans.begin(), ans.end());
+  ans.erase(std::unique(ans.begin(), ans.end()), ans.end());
+  return ans;
+}
+}  // namespace my
+
+template <typename T>
+class BasicPolygon : public BasicShape<T> {
+ public:
+  using real = typename BasicShape<T>::real;
+
  private:
-  bool is_z_sign_posotive(const Point& first, const Point& second,
-                          const Point& third) const {
-    my::Vector v1(first, second);
-    my::Vector v2(second, third);
+  using traits = my::scalar_traits<T>;
 
-    return v1.x_coord * v2.y_coord > v2.x_coord * v1.y_coord;
+  bool is_z_sign_posotive(const BasicPoint<T>& first,
+                          const BasicPoint<T>& second,
+                          const BasicPoint<T>& third) const {
+    return my::orient2d(first, second, third) > 0;
   }
 
  protected:
-  std::vector<Point> points_;
+  std::vector<BasicPoint<T>> points_;
+  // пересчитывается при каждом изменении вершин
+  my::BoundingBox<real> bbox_;
+
+  void update_bounds() {
+    if (points_.empty()) {
+      return;
+    }
+    bbox_ = {real(points_[0].x), real(points_[0].y), real(points_[0].x),
+             real(points_[0].y)};
+    for (const auto& vertex : points_) {
+      bbox_.min_x = std::min<real>(bbox_.min_x, vertex.x);
+      bbox_.min_y = std::min<real>(bbox_.min_y, vertex.y);
+      bbox_.max_x = std::max<real>(bbox_.max_x, vertex.x);
+      bbox_.max_y = std::max<real>(bbox_.max_y, vertex.y);
+    }
+  }
 
  public:
-  Polygon() = default;
+  BasicPolygon() = default;
 
-  Polygon(const std::vector<Point>& points) : points_(points) {}
+  BasicPolygon(const std::vector<BasicPoint<T>>& points) : points_(points) {
+    update_bounds();
+  }
+
+  BasicPolygon(const my::SoAVertices<T>& vertices)
+      : points_(vertices.points()) {
+    update_bounds();
+  }
 
-  template <typename... T>
-  Polygon(T... elems) : points_{elems...} {}
+  template <typename... U>
+  BasicPolygon(U... elems) : points_{elems...} {
+    update_bounds();
+  }
 
   size_t verticesCount() const {
     return points_.size();
   }
 
-  std::vector<Point> getVertices() const {
+  std::vector<BasicPoint<T>> getVertices() const {
     return points_;
   }
 
+  my::SoAVertices<T> getSoAVertices() const {
+    return my::SoAVertices<T>(points_);
+  }
+
   bool isConvex() const {
     bool sign = is_z_sign_posotive(points_[0], points_[1 % points_.size()],
                                    points_[2 % points_.size()]);
@@ -373,46 +1666,133 @@ class Polygon : public Shape {
       }
     }
 
-    return true;
+    // У самопересекающейся звезды повороты тоже одного знака, но
+    // направление рёбер делает несколько оборотов, и знак dx меняется
+    // больше двух раз.
+    int first = 0;
+    int last = 0;
+    size_t changes = 0;
+    for (size_t i = 0, prev = points_.size() - 1; i < points_.size();
+         prev = i++) {
+      int cnt = (points_[prev].x < points_[i].x) -
+                (points_[i].x < points_[prev].x);
+      if (cnt == 0) {
+        continue;
+      }
+      if (first == 0) {
+        first = cnt;
+      } else if (cnt != last) {
+        ++changes;
+      }
+      last = cnt;
+    }
+    changes += last != first;
+
+    return changes <= 2;
   }
 
-  double perimeter() const final {
-    double ans = 0;
+  // Нет пересечений рёбер, кроме общих вершин соседних рёбер.
+  bool isSimple() const {
+    size_t n = points_.size();
+    if (n < 3) {
+      return false;
+    }
+
+    std::vector<BasicSegment<T>> edges;
+    edges.reserve(n);
+    for (size_t i = 0, prev = n - 1; i < n; prev = i++) {
+      if (points_[prev].x == points_[i].x && points_[prev].y == points_[i].y) {
+        return false;
+      }
+      edges.emplace_back(points_[prev], points_[i]);
+    }
 
-    for (size_t i = 0; i < points_.size(); ++i) {
-      ans += points_[i].distance(points_[(i + 1) % points_.size()]);
+    // соседние рёбра (a, v) и (v, b) касаются в v законно, если не
+    // накладываются: b не лежит на луче из v в a
+    auto same_side = [](T a, T v, T b) {
+      return (a < v && b < v) || (v < a && v < b);
+    };
+    auto folds_back = [&](const BasicPoint<T>& a, const BasicPoint<T>& v,
+                          const BasicPoint<T>& b) {
+      return my::orient2d(a, v, b) == 0 &&
+             (same_side(a.x, v.x, b.x) || same_side(a.y, v.y, b.y));
+    };
+
+    bool simple = true;
+    // ребро i - это (i - 1, i)
+    my::for_each_intersection(edges, [&](size_t i, size_t j) {
+      if (j == i + 1 && !folds_back(points_[(i + n - 1) % n], points_[i],
+                                    points_[j % n])) {
+        return false;
+      }
+      if (i == 0 && j == n - 1 &&
+          !folds_back(points_[0], points_[n - 1], points_[n - 2])) {
+        return false;
+      }
+      simple = false;
+      return true;
+    });
+    return simple;
+  }
+
+  // Циклы идут по рёбрам (prev, i) с prev = n - 1 на первом шаге, так что
+  // индексы по модулю не нужны.
+  real perimeter() const final {
+    real ans = 0;
+
+    for (size_t i = 0, prev = points_.size() - 1; i < points_.size();
+         prev = i++) {
+      ans += points_[prev].distance(points_[i]);
     }
     return ans;
   }
 
-  double area() const override {
-    double ans = 0;
+  real area() const override {
+    real ans = 0;
 
-    for (size_t i = 0; i < points_.size(); ++i) {
-      ans +=
-          points_[i].x * (points_[(i + 1) % points_.size()].y -
-                          points_[(i - 1 + points_.size()) % points_.size()].y);
+    for (size_t i = 0, prev = points_.size() - 1; i < points_.size();
+         prev = i++) {
+      ans += real(points_[prev].x) * real(points_[i].y) -
+             real(points_[i].x) * real(points_[prev].y);
     }
 
     return std::abs(ans / 2);
   }
 
-  bool containsPoint(const Point& point) const override {
+  my::BoundingBox<real> boundingBox() const final {
+    return bbox_;
+  }
+
+  // минимальный описанный круг вершин, ожидаемое O(n)
+  BasicCircle<T> boundingCircle() const override {
+    return my::min_enclosing_circle(points_);
+  }
+
+  bool containsPoint(const BasicPoint<T>& point) const override {
+    if (!bbox_.contains(point)) {
+      return false;
+    }
+
     bool result = false;
 
-    for (size_t i = 0; i < points_.size(); ++i) {
-      size_t next_i = (i + 1) % points_.size();
-      if (((points_[i].y < point.y && points_[next_i].y >= point.y) ||
-           // Check if the point is to the left of the line between the two
-           // points
-           (points_[next_i].y < point.y && points_[i].y >= point.y)) &&
-          // Check if the point is to the left of the line defined by the two
-          // points
-          (points_[i].x + (point.y - points_[i].y) /
-                              (points_[next_i].y - points_[i].y) *
-                              (points_[next_i].x - points_[i].x) <
-           point.x)) {
-        // Invert result if point is outside of the polygon
+    for (size_t i = 0, prev = points_.size() - 1; i < points_.size();
+         prev = i++) {
+      const BasicPoint<T>& cnt = points_[prev];
+      const BasicPoint<T>& next = points_[i];
+      double orientation = my::orient2d(cnt, next, point);
+
+      // точка на границе считается лежащей внутри, как у Circle и Ellipse
+      if (orientation == 0 && std::min(cnt.x, next.x) <= point.x &&
+          point.x <= std::max(cnt.x, next.x) &&
+          std::min(cnt.y, next.y) <= point.y &&
+          point.y <= std::max(cnt.y, next.y)) {
+        return true;
+      }
+
+      // Ребро пересекает горизонтальный луч из точки влево: для ребра,
+      // идущего вверх, точка должна быть справа от него, вниз - слева
+      if ((cnt.y < point.y && next.y >= point.y && orientation < 0) ||
+          (next.y < point.y && cnt.y >= point.y && orientation > 0)) {
         result = !result;
       }
     }
@@ -420,38 +1800,49 @@ class Polygon : public Shape {
     return result;
   }
 
-  void rotate(const Point& point, double angle) final {
-    for (size_t i = 0; i < points_.size(); ++i) {
-      points_[i] = point + my::Vector(point, points_[i]).rotated(angle);
+  void rotate(const BasicPoint<T>& point, real angle) final {
+    real cos_a = std::cos(angle);
+    real sin_a = std::sin(angle);
+
+    for (auto& vertex : points_) {
+      real dx = real(vertex.x) - real(point.x);
+      real dy = real(vertex.y) - real(point.y);
+      vertex = point + my::BasicVector<T>(
+                           traits::from_real(cos_a * dx - sin_a * dy),
+                           traits::from_real(cos_a * dy + sin_a * dx));
     }
+    update_bounds();
   }
 
-  void reflect(const Point& point) final {
+  void reflect(const BasicPoint<T>& point) final {
     for (size_t i = 0; i < points_.size(); ++i) {
-      points_[i] = point + -my::Vector(point, points_[i]);
+      points_[i] = point + -my::BasicVector<T>(point, points_[i]);
     }
+    update_bounds();
   }
 
-  void reflect(const Line& line) final {
+  void reflect(const BasicLine<T>& line) final {
     for (size_t i = 0; i < points_.size(); ++i) {
       points_[i] = points_[i].symmetrical(line);
     }
+    update_bounds();
   }
 
-  void scale(const Point& point, double coef) final {
-    for (size_t i = 0; i < points_.size(); ++i) {
-      points_[i] = point + my::Vector(point, points_[i]) * coef;
+  void scale(const BasicPoint<T>& point, real coef) final {
+    for (auto& vertex : points_) {
+      vertex = point + my::BasicVector<T>(point, vertex) * coef;
     }
+    update_bounds();
   }
 
-  bool operator==(const Shape& other) const final {
-    const Polygon* pol_others = dynamic_cast<const Polygon*>(&other);
+  bool operator==(const BasicShape<T>& other) const final {
+    const BasicPolygon* pol_others = dynamic_cast<const BasicPolygon*>(&other);
 
     if (pol_others != nullptr) {
-      std::vector<Point> this_points = getVertices();
-      std::vector<Point> this_points_rev = this_points;
+      std::vector<BasicPoint<T>> this_points = getVertices();
+      std::vector<BasicPoint<T>> this_points_rev = this_points;
       std::reverse(this_points_rev.begin(), this_points_rev.end());
-      std::vector<Point> other_points = pol_others->getVertices();
+      std::vector<BasicPoint<T>> other_points = pol_others->getVertices();
 
       if (this_points.size() != other_points.size()) {
         return false;
@@ -471,7 +1862,7 @@ class Polygon : public Shape {
             all_good_2 = false;
           }
 
-          if (!all_good_1 && !all_good_1) {
+          if (!all_good_1 && !all_good_2) {
             break;
           }
         }
@@ -487,198 +1878,270 @@ class Polygon : public Shape {
   }
 };
 
-class Rectangle : public Polygon {
+using Polygon = BasicPolygon<double>;
+
+template <typename T>
+class BasicRectangle : public BasicPolygon<T> {
+ public:
+  using real = typename BasicPolygon<T>::real;
+
+ protected:
+  using BasicPolygon<T>::points_;
+
  public:
-  Rectangle(const Point& P1, const Point& P3, double coef) {
-    Point center = (my::Vector(P1) + my::Vector(P3)) * 0.5;
-    my::Vector cnt = my::Vector(P1) + -my::Vector(center);
-    Point P2(my::Vector(center) + cnt.rotated(-2 * std::atan(coef)));
-    Point P4 = P3 + -my::Vector(P1, P2);
+  BasicRectangle(const BasicPoint<T>& P1, const BasicPoint<T>& P3, real coef) {
+    BasicPoint<T> center =
+        (my::BasicVector<T>(P1) + my::BasicVector<T>(P3)) * 0.5;
+    my::BasicVector<T> cnt =
+        my::BasicVector<T>(P1) + -my::BasicVector<T>(center);
+    BasicPoint<T> P2(my::BasicVector<T>(center) +
+                     cnt.rotated(-2 * std::atan(coef)));
+    BasicPoint<T> P4 = P3 + -my::BasicVector<T>(P1, P2);
     points_ = {P1, P2, P3, P4};
+    this->update_bounds();
+  }
+
+  BasicCircle<T> boundingCircle() const override {
+    return my::detail::to_circle<T>(my::detail::disk<real>(points_[0],
+                                                           points_[2]));
   }
 
-  Point center() const {
-    return Point((my::Vector(points_[0]) + my::Vector(points_[2])) * 0.5);
+  BasicPoint<T> center() const {
+    return BasicPoint<T>(
+        (my::BasicVector<T>(points_[0]) + my::BasicVector<T>(points_[2])) *
+        0.5);
   }
 
-  std::pair<Line, Line> diagonals() const {
-    return std::make_pair(Line(points_[0], points_[2]),
-                          Line(points_[1], points_[3]));
+  std::pair<BasicLine<T>, BasicLine<T>> diagonals() const {
+    return std::make_pair(BasicLine<T>(points_[0], points_[2]),
+                          BasicLine<T>(points_[1], points_[3]));
   }
 
-  double area() const override {
+  real area() const override {
     return points_[0].distance(points_[1]) * points_[1].distance(points_[2]);
   }
 };
 
-class Square : public Rectangle {
+using Rectangle = BasicRectangle<double>;
+
+template <typename T>
+class BasicSquare : public BasicRectangle<T> {
  public:
-  Square(const Point& P1, const Point& P3) : Rectangle(P1, P3, 1) {}
+  using real = typename BasicRectangle<T>::real;
+
+ protected:
+  using BasicRectangle<T>::points_;
 
-  Circle inscribedCircle() const {
-    return Circle(center(), points_[0].distance(points_[1]) / 2);
+ public:
+  using BasicRectangle<T>::center;
+
+  BasicSquare(const BasicPoint<T>& P1, const BasicPoint<T>& P3)
+      : BasicRectangle<T>(P1, P3, 1) {}
+
+  BasicCircle<T> inscribedCircle() const {
+    return BasicCircle<T>(center(), points_[0].distance(points_[1]) / 2);
   }
 
-  Circle circumscribedCircle() const {
-    return Circle(center(), points_[0].distance(center()) / 2);
+  BasicCircle<T> circumscribedCircle() const {
+    return BasicCircle<T>(center(), points_[0].distance(center()) / 2);
   }
 
-  double area() const final {
+  real area() const final {
     return std::pow(points_[0].distance(points_[1]), 2);
   }
 };
 
-class Triangle : public Polygon {
+using Square = BasicSquare<double>;
+
+template <typename T>
+class BasicTriangle : public BasicPolygon<T> {
  public:
-  using Polygon::Polygon;
+  using real = typename BasicPolygon<T>::real;
 
-  Point inCenter() const {
-    my::Vector v1(points_[0], points_[1]);
-    my::Vector v2(points_[0], points_[2]);
-    double angle = std::acos(my::ScalarProduct(v1, v2) / (v1.abs() * v2.abs()));
-    double r = 2 * area() / perimeter();
+ private:
+  using traits = my::scalar_traits<T>;
+
+ protected:
+  using BasicPolygon<T>::points_;
+
+ public:
+  using BasicPolygon<T>::BasicPolygon;
+  using BasicPolygon<T>::perimeter;
+
+  BasicPoint<T> inCenter() const {
+    my::BasicVector<T> v1(points_[0], points_[1]);
+    my::BasicVector<T> v2(points_[0], points_[2]);
+    real angle = std::acos(my::ScalarProduct(v1, v2) / (v1.abs() * v2.abs()));
+    real r = 2 * area() / perimeter();
 
     return points_[0] + (v1.normed() + v2.normed()).normed() *
                             (r / std::sin(angle / 2));  ///???
   }
 
-  Circle inscribedCircle() const {
-    return Circle(inCenter(), 2 * area() / perimeter());
+  BasicCircle<T> inscribedCircle() const {
+    return BasicCircle<T>(inCenter(), 2 * area() / perimeter());
   }
 
-  Point centroid() const {
-    return points_[0] + (my::Vector(points_[0], points_[1]) +
-                         my::Vector(points_[0], points_[2])) *
+  BasicPoint<T> centroid() const {
+    return points_[0] + (my::BasicVector<T>(points_[0], points_[1]) +
+                         my::BasicVector<T>(points_[0], points_[2])) *
                             (1. / 3);
   }
 
-  Circle circumscribedCircle() const {
-    return Circle(outcenter(), points_[0].distance(points_[1]) *
-                                   points_[0].distance(points_[2]) *
-                                   points_[1].distance(points_[2]) /
-                                   (4 * area()));
+  BasicCircle<T> circumscribedCircle() const {
+    return BasicCircle<T>(outcenter(), points_[0].distance(points_[1]) *
+                                           points_[0].distance(points_[2]) *
+                                           points_[1].distance(points_[2]) /
+                                           (4 * area()));
   }
 
-  Point outcenter() const {
-    Point A = points_[0];
-    Point B = points_[1];
-    Point C = points_[2];
+  BasicPoint<T> outcenter() const {
+    real ax = points_[0].x;
+    real ay = points_[0].y;
+    real bx = points_[1].x;
+    real by = points_[1].y;
+    real cx = points_[2].x;
+    real cy = points_[2].y;
 
-    double denom =
-        2 * (A.x * (B.y - C.y) + B.x * (C.y - A.y) + C.x * (A.y - B.y));
+    real denom = 2 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
 
-    double x_coord = ((std::pow(A.x, 2) + std::pow(A.y, 2)) * (B.y - C.y) +
-                      (std::pow(B.x, 2) + std::pow(B.y, 2)) * (C.y - A.y) +
-                      (std::pow(C.x, 2) + std::pow(C.y, 2)) * (A.y - B.y)) /
-                     denom;
-    double y_coord = ((std::pow(A.x, 2) + std::pow(A.y, 2)) * (C.x - B.x) +
-                      (std::pow(B.x, 2) + std::pow(B.y, 2)) * (A.x - C.x) +
-                      (std::pow(C.x, 2) + std::pow(C.y, 2)) * (B.x - A.x)) /
-                     denom;
-    return Point(x_coord, y_coord);
+    real x_coord = ((std::pow(ax, 2) + std::pow(ay, 2)) * (by - cy) +
+                    (std::pow(bx, 2) + std::pow(by, 2)) * (cy - ay) +
+                    (std::pow(cx, 2) + std::pow(cy, 2)) * (ay - by)) /
+                   denom;
+    real y_coord = ((std::pow(ax, 2) + std::pow(ay, 2)) * (cx - bx) +
+                    (std::pow(bx, 2) + std::pow(by, 2)) * (ax - cx) +
+                    (std::pow(cx, 2) + std::pow(cy, 2)) * (bx - ax)) /
+                   denom;
+    return BasicPoint<T>(traits::from_real(x_coord),
+                         traits::from_real(y_coord));
   }
 
-  Point orthocenter() const {
-    return Point(
+  BasicPoint<T> orthocenter() const {
+    return BasicPoint<T>(
         centroid() +
-        my::Vector(outcenter(), centroid()) *
+        my::BasicVector<T>(outcenter(), centroid()) *
             2);  // Point(centroid()) + my::Vector(out, cen).scale(-1./2)
   }
 
-  Line EulerLine() const {
-    return Line(orthocenter(), centroid());
+  BasicLine<T> EulerLine() const {
+    return BasicLine<T>(orthocenter(), centroid());
   }
 
-  Circle ninePointsCircle() const {
-    Circle ans = circumscribedCircle();
+  BasicCircle<T> ninePointsCircle() const {
+    BasicCircle<T> ans = circumscribedCircle();
     ans.scale(orthocenter(), 1. / 2);
     return ans;
   }
 
-  double area() const final {
-    double a = points_[0].distance(points_[1]);
-    double b = points_[0].distance(points_[2]);
-    double c = points_[1].distance(points_[2]);
-    double p = (a + b + c) / 2;
+  real area() const final {
+    real a = points_[0].distance(points_[1]);
+    real b = points_[0].distance(points_[2]);
+    real c = points_[1].distance(points_[2]);
+    real p = (a + b + c) / 2;
 
     return std::sqrt(p * (p - a) * (p - b) * (p - c));
   }
 };
 
-bool Shape::isCongruentTo(const Shape& other) const {
-  const Ellipse* cnt_this = dynamic_cast<const Ellipse*>(this);
-  const Ellipse* cnt_other = dynamic_cast<const Ellipse*>(&other);
+using Triangle = BasicTriangle<double>;
+
+template <typename T>
+bool BasicShape<T>::isCongruentTo(const BasicShape<T>& other) const {
+  using real_traits = my::scalar_traits<real>;
+
+  const BasicEllipse<T>* cnt_this = dynamic_cast<const BasicEllipse<T>*>(this);
+  const BasicEllipse<T>* cnt_other =
+      dynamic_cast<const BasicEllipse<T>*>(&other);
 
   if (cnt_this != nullptr && cnt_other != nullptr) {
     auto this_focuses = cnt_this->focuses();
     auto other_focuses = cnt_other->focuses();
-    return (my::Vector(this_focuses.first, other_focuses.first)
-                .is_collinear(
-                    my::Vector(this_focuses.second, other_focuses.second)) ||
-            my::Vector(this_focuses.second, other_focuses.first)
-                .is_collinear(
-                    my::Vector(this_focuses.first, other_focuses.second))) &&
-           my::double_equal(cnt_this->eccentricity(),
-                            cnt_other->eccentricity());
+    return (my::BasicVector<T>(this_focuses.first, other_focuses.first)
+                .is_collinear(my::BasicVector<T>(this_focuses.second,
+                                                 other_focuses.second)) ||
+            my::BasicVector<T>(this_focuses.second, other_focuses.first)
+                .is_collinear(my::BasicVector<T>(this_focuses.first,
+                                                 other_focuses.second))) &&
+           real_traits::equal(cnt_this->eccentricity(),
+                              cnt_other->eccentricity());
   }
 
-  const Circle* cir_this = dynamic_cast<const Circle*>(this);
-  const Circle* cir_other = dynamic_cast<const Circle*>(&other);
+  const BasicCircle<T>* cir_this = dynamic_cast<const BasicCircle<T>*>(this);
+  const BasicCircle<T>* cir_other =
+      dynamic_cast<const BasicCircle<T>*>(&other);
 
   if (cir_this != nullptr && cir_other != nullptr) {
-    return my::double_equal(cir_other->radius(), cir_this->radius());
+    return real_traits::equal(cir_other->radius(), cir_this->radius());
   }
 
-  const Polygon* pol_this = dynamic_cast<const Polygon*>(this);
-  const Polygon* pol_others = dynamic_cast<const Polygon*>(&other);
+  const BasicPolygon<T>* pol_this = dynamic_cast<const BasicPolygon<T>*>(this);
+  const BasicPolygon<T>* pol_others =
+      dynamic_cast<const BasicPolygon<T>*>(&other);
 
   if (pol_others != nullptr && pol_this != nullptr) {
-    std::vector<Point> this_points = pol_this->getVertices();
-    std::vector<Point> this_points_rev = this_points;
+    std::vector<BasicPoint<T>> this_points = pol_this->getVertices();
+    std::vector<BasicPoint<T>> this_points_rev = this_points;
     std::reverse(this_points_rev.begin(), this_points_rev.end());
-    std::vector<Point> other_points = pol_others->getVertices();
+    std::vector<BasicPoint<T>> other_points = pol_others->getVertices();
 
     if (this_points.size() != other_points.size()) {
       return false;
     }
 
+    // Периметр и радиус описанного круга не меняются при движении: O(n)
+    // отсев до перебора O(n^2). Допуск - накопленная по сторонам ошибка.
+    real tolerance = real_traits::accuracy * this_points.size();
+    real this_perimeter = pol_this->perimeter();
+    if (std::abs(this_perimeter - pol_others->perimeter()) >
+        tolerance * (1 + this_perimeter)) {
+      return false;
+    }
+    real this_radius = my::detail::enclosing_disk(this_points).r;
+    if (std::abs(this_radius - my::detail::enclosing_disk(other_points).r) >
+        tolerance * (1 + this_radius)) {
+      return false;
+    }
+
     for (size_t i = 0; i < this_points.size(); ++i) {
       bool all_good_1 = true;
       bool all_good_2 = true;
 
       for (size_t j = 0; j < this_points.size(); ++j) {
-        my::Vector v1 =
-            my::Vector(this_points[(i + j) % this_points.size()],
-                       this_points[(i + j + 1) % this_points.size()]);
-        my::Vector v2 =
-            my::Vector(this_points[(i + j + 1) % this_points.size()],
-                       this_points[(i + j + 2) % this_points.size()]);
-
-        my::Vector v3 = my::Vector(other_points[j % other_points.size()],
-                                   other_points[(j + 1) % other_points.size()]);
-        my::Vector v4 = my::Vector(other_points[(j + 1) % other_points.size()],
-                                   other_points[(j + 2) % other_points.size()]);
-
-        my::Vector v5 =
-            my::Vector(this_points_rev[(i + j) % this_points_rev.size()],
-                       this_points_rev[(i + j + 1) % this_points_rev.size()]);
-        my::Vector v6 =
-            my::Vector(this_points_rev[(i + j + 1) % this_points_rev.size()],
-                       this_points_rev[(i + j + 2) % this_points_rev.size()]);
-
-        if (!my::double_equal(v1.abs(), v3.abs()) ||
-            !my::double_equal(my::ScalarProduct(v1, v2),
-                              my::ScalarProduct(v3, v4))) {
+        my::BasicVector<T> v1 =
+            my::BasicVector<T>(this_points[(i + j) % this_points.size()],
+                               this_points[(i + j + 1) % this_points.size()]);
+        my::BasicVector<T> v2 =
+            my::BasicVector<T>(this_points[(i + j + 1) % this_points.size()],
+                               this_points[(i + j + 2) % this_points.size()]);
+
+        my::BasicVector<T> v3 =
+            my::BasicVector<T>(other_points[j % other_points.size()],
+                               other_points[(j + 1) % other_points.size()]);
+        my::BasicVector<T> v4 =
+            my::BasicVector<T>(other_points[(j + 1) % other_points.size()],
+                               other_points[(j + 2) % other_points.size()]);
+
+        my::BasicVector<T> v5 = my::BasicVector<T>(
+            this_points_rev[(i + j) % this_points_rev.size()],
+            this_points_rev[(i + j + 1) % this_points_rev.size()]);
+        my::BasicVector<T> v6 = my::BasicVector<T>(
+            this_points_rev[(i + j + 1) % this_points_rev.size()],
+            this_points_rev[(i + j + 2) % this_points_rev.size()]);
+
+        if (!real_traits::equal(v1.abs(), v3.abs()) ||
+            !real_traits::equal(my::ScalarProduct(v1, v2),
+                                my::ScalarProduct(v3, v4))) {
           all_good_1 = false;
         }
 
-        if (!my::double_equal(v5.abs(), v3.abs()) ||
-            !my::double_equal(my::ScalarProduct(v5, v6),
-                              my::ScalarProduct(v3, v4))) {
+        if (!real_traits::equal(v5.abs(), v3.abs()) ||
+            !real_traits::equal(my::ScalarProduct(v5, v6),
+                                my::ScalarProduct(v3, v4))) {
           all_good_2 = false;
         }
 
-        if (!all_good_1 && !all_good_1) {
+        if (!all_good_1 && !all_good_2) {
           break;
         }
       }
@@ -693,30 +2156,36 @@ bool Shape::isCongruentTo(const Shape& other) const {
   return false;
 }
 
-bool Shape::isSimilarTo(const Shape& other) const {
-  const Ellipse* cnt_this = dynamic_cast<const Ellipse*>(this);
-  const Ellipse* cnt_other = dynamic_cast<const Ellipse*>(&other);
+template <typename T>
+bool BasicShape<T>::isSimilarTo(const BasicShape<T>& other) const {
+  using real_traits = my::scalar_traits<real>;
+
+  const BasicEllipse<T>* cnt_this = dynamic_cast<const BasicEllipse<T>*>(this);
+  const BasicEllipse<T>* cnt_other =
+      dynamic_cast<const BasicEllipse<T>*>(&other);
 
   if (cnt_this != nullptr && cnt_other != nullptr) {
-    return my::double_equal(cnt_this->eccentricity(),
-                            cnt_other->eccentricity());
+    return real_traits::equal(cnt_this->eccentricity(),
+                              cnt_other->eccentricity());
   }
 
-  const Circle* cir_this = dynamic_cast<const Circle*>(this);
-  const Circle* cir_other = dynamic_cast<const Circle*>(&other);
+  const BasicCircle<T>* cir_this = dynamic_cast<const BasicCircle<T>*>(this);
+  const BasicCircle<T>* cir_other =
+      dynamic_cast<const BasicCircle<T>*>(&other);
 
   if (cir_this != nullptr && cir_other != nullptr) {
     return true;
   }
 
-  const Polygon* pol_this = dynamic_cast<const Polygon*>(this);
-  const Polygon* pol_others = dynamic_cast<const Polygon*>(&other);
+  const BasicPolygon<T>* pol_this = dynamic_cast<const BasicPolygon<T>*>(this);
+  const BasicPolygon<T>* pol_others =
+      dynamic_cast<const BasicPolygon<T>*>(&other);
 
   if (pol_others != nullptr && pol_this != nullptr) {
-    Polygon copy_this = *dynamic_cast<const Polygon*>(this);
+    BasicPolygon<T> copy_this = *pol_this;
 
-    double s = other.perimeter() / perimeter();
-    copy_this.scale(Point(0, 0), s);
+    real s = other.perimeter() / perimeter();
+    copy_this.scale(BasicPoint<T>(0, 0), s);
 
     return copy_this.isCongruentTo(other);
   }
@@ -0,0 +1,303 @@
+// Замеры производительности геометрии.
+//
+//   g++ -std=c++20 -O2 -pthread geometry_bench.cpp -o geometry_bench
+//   ./geometry_bench [all|shapes|classify] [max_threads]
+//
+// shapes - операции фигур: ns на операцию и, где есть вершины, вершин в
+// секунду; у многоугольников рядом те же операции над SoAVertices.
+// classify - классификация точек по фигурам на 1..N потоках.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "classify.h"
+
+namespace {
+const double kMinTime = 0.2;
+
+volatile double sink = 0;
+
+template <typename Func>
+double seconds(Func func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Повторяет func удваивающимися пачками, пока не наберётся kMinTime.
+template <typename Func>
+void report(const std::string& name, size_t vertices, Func func) {
+  size_t ops = 0;
+  double time = 0;
+  for (size_t batch = 1; time < kMinTime; batch *= 2) {
+    time += seconds([&]() {
+      for (size_t i = 0; i < batch; ++i) {
+        func();
+      }
+    });
+    ops += batch;
+  }
+
+  double ns = time * 1e9 / ops;
+  std::printf("  %-34s %8zu %14.1f ns/op", name.c_str(), vertices, ns);
+  if (vertices != 0) {
+    std::printf(" %12.3g vertices/s", vertices * 1e9 / ns);
+  }
+  std::printf("\n");
+}
+
+// простой звёздчатый многоугольник: вершины по кругу, радиус дрожит
+Polygon star_polygon(size_t n, std::mt19937& gen) {
+  std::uniform_real_distribution<double> radius(0.7, 1);
+  std::vector<Point> vertices;
+  vertices.reserve(n);
+  for (size_t k = 0; k < n; ++k) {
+    double angle = 2 * M_PI * k / n;
+    double r = radius(gen);
+    vertices.emplace_back(r * std::cos(angle), r * std::sin(angle));
+  }
+  return Polygon(vertices);
+}
+
+// точки в удвоенном bbox фигуры: примерно половина промахов
+std::vector<Point> query_points(const Shape& shape, size_t count,
+                                std::mt19937& gen) {
+  auto box = shape.boundingBox();
+  double cx = (box.min_x + box.max_x) / 2;
+  double cy = (box.min_y + box.max_y) / 2;
+  std::uniform_real_distribution<double> dx(-(box.max_x - box.min_x),
+                                            box.max_x - box.min_x);
+  std::uniform_real_distribution<double> dy(-(box.max_y - box.min_y),
+                                            box.max_y - box.min_y);
+  std::vector<Point> points;
+  for (size_t i = 0; i < count; ++i) {
+    points.emplace_back(cx + dx(gen), cy + dy(gen));
+  }
+  return points;
+}
+
+void bench_contains(std::mt19937& gen) {
+  std::printf("containsPoint\n");
+
+  std::vector<std::pair<std::string, std::unique_ptr<Shape>>> shapes;
+  for (size_t n : {10, 1000, 100'000}) {
+    shapes.emplace_back("Polygon",
+                        std::make_unique<Polygon>(star_polygon(n, gen)));
+  }
+  shapes.emplace_back("Rectangle", std::make_unique<Rectangle>(
+                                       Point(0, 0), Point(3, 2), 0.3));
+  shapes.emplace_back("Square",
+                      std::make_unique<Square>(Point(0, 0), Point(3, 2)));
+  shapes.emplace_back("Triangle", std::make_unique<Triangle>(
+                                      Point(0, 0), Point(3, 1), Point(1, 2)));
+  shapes.emplace_back("Circle", std::make_unique<Circle>(Point(1, 1), 2));
+  shapes.emplace_back("Ellipse", std::make_unique<Ellipse>(
+                                     Point(0, 0), Point(3, 1), 5));
+
+  for (const auto& [name, shape] : shapes) {
+    std::vector<Point> points = query_points(*shape, 4096, gen);
+    auto* polygon = dynamic_cast<const Polygon*>(shape.get());
+    size_t vertices = polygon != nullptr ? polygon->verticesCount() : 0;
+    size_t next = 0;
+    report(name, vertices, [&]() {
+      sink = sink + shape->containsPoint(points[next++ & 4095]);
+    });
+    // те же вершины структурой массивов: фильтрованный проход без bbox
+    if (name == "Polygon") {
+      my::SoAVertices<double> soa = polygon->getSoAVertices();
+      report("SoAVertices", vertices, [&]() {
+        sink = sink + soa.containsPoint(points[next++ & 4095]);
+      });
+    }
+  }
+}
+
+void bench_measures(std::mt19937& gen) {
+  std::printf("area / perimeter\n");
+  for (size_t n = 10; n <= 1'000'000; n *= 10) {
+    Polygon polygon = star_polygon(n, gen);
+    report("Polygon::area", n, [&]() { sink = sink + polygon.area(); });
+    report("Polygon::perimeter", n,
+           [&]() { sink = sink + polygon.perimeter(); });
+    my::SoAVertices<double> soa = polygon.getSoAVertices();
+    report("SoAVertices::area", n, [&]() { sink = sink + soa.area(); });
+    report("SoAVertices::perimeter", n,
+           [&]() { sink = sink + soa.perimeter(); });
+  }
+}
+
+void bench_transforms(std::mt19937& gen) {
+  std::printf("rotate / reflect / scale\n");
+  Line axis(Point(0, 0), Point(1, 2));
+  Point pivot(0.3, -0.2);
+
+  // отражение и масштаб чередуются с обратными, чтобы фигура не уплывала
+  auto run = [&](const std::string& name, size_t vertices, Shape& shape) {
+    report(name + "::rotate", vertices, [&]() { shape.rotate(pivot, 0.1); });
+    report(name + "::reflect(point)", vertices,
+           [&]() { shape.reflect(pivot); });
+    report(name + "::reflect(line)", vertices,
+           [&]() { shape.reflect(axis); });
+    double coef = 1.001;
+    report(name + "::scale", vertices, [&]() {
+      shape.scale(pivot, coef);
+      coef = 1 / coef;
+    });
+  };
+
+  for (size_t n = 10; n <= 1'000'000; n *= 10) {
+    Polygon polygon = star_polygon(n, gen);
+    run("Polygon", n, polygon);
+    my::SoAVertices<double> soa = polygon.getSoAVertices();
+    report("SoAVertices::rotate", n, [&]() { soa.rotate(pivot, 0.1); });
+    double coef = 1.001;
+    report("SoAVertices::scale", n, [&]() {
+      soa.scale(pivot, coef);
+      coef = 1 / coef;
+    });
+  }
+  Circle circle(Point(1, 1), 2);
+  run("Circle", 0, circle);
+  Ellipse ellipse(Point(0, 0), Point(3, 1), 5);
+  run("Ellipse", 0, ellipse);
+}
+
+// Сравнения многоугольников квадратичны по числу вершин, поэтому размеры
+// до 10^4. Копии сдвинуты по циклу, так что совпадение ищется по сдвигам.
+void bench_equality(std::mt19937& gen) {
+  std::printf("operator== / isCongruentTo / isSimilarTo\n");
+  for (size_t n = 10; n <= 10'000; n *= 10) {
+    Polygon polygon = star_polygon(n, gen);
+    std::vector<Point> vertices = polygon.getVertices();
+    std::rotate(vertices.begin(), vertices.begin() + n / 2, vertices.end());
+    Polygon shifted(vertices);
+    Polygon moved = shifted;
+    moved.rotate(Point(2, 1), 0.7);
+    Polygon scaled = moved;
+    scaled.scale(Point(0, 0), 2.5);
+
+    report("Polygon::operator==", n,
+           [&]() { sink = sink + (polygon == shifted); });
+    report("Polygon::isCongruentTo", n,
+           [&]() { sink = sink + polygon.isCongruentTo(moved); });
+    report("Polygon::isSimilarTo", n,
+           [&]() { sink = sink + polygon.isSimilarTo(scaled); });
+  }
+}
+
+void bench_shapes() {
+  std::mt19937 gen(2024);
+  bench_contains(gen);
+  bench_measures(gen);
+  bench_transforms(gen);
+  bench_equality(gen);
+}
+
+std::vector<std::unique_ptr<Shape>> random_shapes(size_t count,
+                                                  double world,
+                                                  std::mt19937& gen) {
+  std::uniform_real_distribution<double> coord(0, world);
+  std::uniform_real_distribution<double> size(1, 10);
+  std::uniform_real_distribution<double> unit(-1, 1);
+
+  std::vector<std::unique_ptr<Shape>> shapes;
+  shapes.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    Point center(coord(gen), coord(gen));
+    double r = size(gen);
+    switch (i % 5) {
+      case 0:
+        shapes.push_back(std::make_unique<Circle>(center, r));
+        break;
+      case 1:
+        shapes.push_back(std::make_unique<Ellipse>(
+            center, Point(center.x + r * unit(gen), center.y + r * unit(gen)),
+            3 * r));
+        break;
+      case 2:
+        shapes.push_back(std::make_unique<Rectangle>(
+            center, Point(center.x + r, center.y + r), unit(gen)));
+        break;
+      case 3:
+        shapes.push_back(std::make_unique<Triangle>(
+            center, Point(center.x + r, center.y + r * unit(gen)),
+            Point(center.x + r * unit(gen), center.y + r)));
+        break;
+      default: {
+        // звёздчатый многоугольник вокруг центра
+        std::vector<Point> vertices;
+        for (int k = 0; k < 12; ++k) {
+          double angle = 2 * M_PI * k / 12;
+          double len = r * (0.5 + (unit(gen) + 1) / 4);
+          vertices.emplace_back(center.x + len * std::cos(angle),
+                                center.y + len * std::sin(angle));
+        }
+        shapes.push_back(std::make_unique<Polygon>(vertices));
+      }
+    }
+  }
+  return shapes;
+}
+
+void bench_classify(size_t max_threads) {
+  const size_t kShapes = 50'000;
+  const size_t kPoints = 1'000'000;
+  const double kWorld = 1000;
+
+  std::mt19937 gen(2024);
+  auto owned = random_shapes(kShapes, kWorld, gen);
+  std::vector<const Shape*> shapes;
+  for (const auto& shape : owned) {
+    shapes.push_back(shape.get());
+  }
+
+  std::uniform_real_distribution<double> coord(0, kWorld);
+  std::vector<Point> points;
+  points.reserve(kPoints);
+  for (size_t i = 0; i < kPoints; ++i) {
+    points.emplace_back(coord(gen), coord(gen));
+  }
+
+  std::unique_ptr<my::ShapeIndex<double>> index;
+  double build = seconds(
+      [&]() { index = std::make_unique<my::ShapeIndex<double>>(shapes); });
+  std::printf("classify: %zu shapes, %zu points, index built in %.3f s\n",
+              kShapes, kPoints, build);
+
+  // сверка с полным перебором - в geometry_test.cpp (TestClassify)
+  my::Classification reference = index->classify(points, 1);
+  std::printf("  %zu hits in total\n", reference.shapes.size());
+
+  double single = 0;
+  for (size_t threads = 1; threads <= max_threads; ++threads) {
+    double time = seconds([&]() { index->classify(points, threads); });
+    if (threads == 1) {
+      single = time;
+    }
+    std::printf("  threads %2zu: %8.3f s  %8.1f ns/point  speedup %.2f\n",
+                threads, time, time * 1e9 / kPoints, single / time);
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string suite = argc > 1 ? argv[1] : "all";
+  size_t max_threads =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : my::default_threads();
+
+  if (suite == "all" || suite == "shapes") {
+    bench_shapes();
+  }
+  if (suite == "all" || suite == "classify") {
+    bench_classify(max_threads);
+  }
+}
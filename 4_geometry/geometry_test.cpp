@@ -0,0 +1,1222 @@
+// Тесты геометрии.
+//
+//   g++ -std=c++20 -O2 -pthread geometry_test.cpp -o geometry_test
+//   ./geometry_test
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "calipers.h"
+#include "classify.h"
+#include "delaunay.h"
+#include "geometry.h"
+#include "mesh.h"
+#include "shape_io.h"
+
+void TestPointEquality() {
+  // большие координаты: 500 при 1e9 - уже другая точка
+  assert(Point(1e9, 1e9) != Point(1e9 + 500, 1e9));
+  assert(Point(1e9, 1e9) == Point(1e9 + 1e-6, 1e9));
+  // около нуля порог - десятки ulp единицы, а не 1e-6
+  assert(Point(1e-8, 0) != Point(5e-7, 0));
+  assert(Point(1e-8, 0) != Point(1e-8 + 1e-12, 0));
+  assert(Point(1e-8, 0) == Point(1e-8 + 1e-15, 0));
+  assert(Point(0, 0) == Point(0, 0));
+
+  // ошибка округления меряется по всей точке, а не по одной координате
+  Point rotated(std::cos(M_PI / 2), std::sin(M_PI / 2));
+  assert(rotated == Point(0, 1));
+
+  Polygon square(Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1));
+  Polygon turned = square;
+  turned.rotate(Point(0.5, 0.5), M_PI / 2);
+  assert(turned == square);
+
+  assert(BasicPoint<int>(3, 4) == BasicPoint<int>(3, 4));
+  assert(BasicPoint<int>(3, 4) != BasicPoint<int>(3, 5));
+}
+
+void TestEllipsePerimeter() {
+  using my::Precision;
+  // вырожденный: отрезок длины 2a, пройденный дважды
+  assert(my::ellipse_perimeter(3.0, 0.0, Precision::Exact) == 12);
+  assert(my::ellipse_perimeter(0.0, 3.0, Precision::Exact) == 12);
+  assert(my::ellipse_perimeter(0.0, 0.0, Precision::Exact) == 0);
+  assert(my::ellipse_perimeter(1.0, 1e-300, Precision::Exact) == 4);
+
+  // тонкий: P = 4a + 2b^2 / a (ln(4a / b) - 1/2) + O(b^4)
+  for (double b : {1e-4, 1e-6, 1e-9}) {
+    double expected = 4 + 2 * b * b * (std::log(4 / b) - 0.5);
+    double perimeter = my::ellipse_perimeter(1.0, b, Precision::Exact);
+    assert(std::abs(perimeter - expected) < 1e-14);
+  }
+
+  assert(std::abs(my::ellipse_perimeter(1.0, 1.0, Precision::Exact) -
+                  2 * M_PI) < 1e-15);
+  // полный эллиптический интеграл второго рода, e^2 = 3/4
+  assert(std::abs(my::ellipse_perimeter(2.0, 1.0, Precision::Exact) -
+                  9.688448220547675) < 1e-14);
+
+  // Fast и Ramanujan занижают периметр, Ramanujan - меньше; на окружности
+  // обе точны
+  struct {
+    double b;
+    double fast;
+    double ramanujan;
+  } cases[] = {{1, 1e-15, 1e-15},    {0.9, 1e-10, 1e-10}, {0.5, 6e-6, 3e-6},
+               {0.2, 4e-4, 2.2e-4}, {0.05, 3e-3, 1.8e-3}, {0, 6e-3, 4.2e-3}};
+  for (const auto& test : cases) {
+    double exact = my::ellipse_perimeter(1.0, test.b, Precision::Exact);
+    double fast = my::ellipse_perimeter(1.0, test.b, Precision::Fast);
+    double ramanujan =
+        my::ellipse_perimeter(1.0, test.b, Precision::Ramanujan);
+    assert(exact - fast >= -1e-15 && exact - fast <= test.fast * exact);
+    assert(exact - ramanujan >= -1e-15 &&
+           exact - ramanujan <= test.ramanujan * exact);
+    assert(exact - ramanujan <= exact - fast);
+    // формулы симметричны по полуосям
+    assert(std::abs(my::ellipse_perimeter(test.b, 1.0, Precision::Fast) -
+                    fast) < 1e-15);
+    assert(std::abs(my::ellipse_perimeter(test.b, 1.0, Precision::Ramanujan) -
+                    ramanujan) < 1e-15);
+  }
+
+  // пакетная форма совпадает со скалярной для каждой формулы, включая
+  // хвост нечётной длины
+  std::mt19937 gen(29);
+  std::uniform_real_distribution<double> axis(0, 10);
+  std::vector<double> a(37);
+  std::vector<double> b(37);
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = axis(gen);
+    b[i] = i % 5 == 0 ? 0 : axis(gen);
+  }
+  std::vector<Ellipse> ellipses;
+  for (size_t i = 0; i < a.size(); ++i) {
+    double major = std::max(a[i], b[i]);
+    double focal = std::sqrt(major * major - std::pow(std::min(a[i], b[i]), 2));
+    ellipses.emplace_back(Point(-focal, 1), Point(focal, 1), 2 * major);
+  }
+  for (Precision precision :
+       {Precision::Fast, Precision::Ramanujan, Precision::Exact}) {
+    std::vector<double> out(a.size());
+    my::ellipse_perimeters(a.data(), b.data(), out.data(), out.size(),
+                           precision);
+    std::vector<double> from_ellipses =
+        my::ellipse_perimeters(ellipses, precision);
+    for (size_t i = 0; i < a.size(); ++i) {
+      assert(out[i] == my::ellipse_perimeter(a[i], b[i], precision));
+      double scalar = ellipses[i].perimeter(precision);
+      assert(from_ellipses[i] == scalar);
+      assert(std::abs(scalar - out[i]) <= 1e-12 * std::max(1.0, out[i]));
+    }
+    my::ellipse_perimeters(a.data(), b.data(), out.data(), 0, precision);
+  }
+}
+
+// Треугольники против часовой стрелки, невырожденные, с пустыми описанными
+// окружностями; вместе покрывают area.
+void CheckDelaunay(const my::TriangleMesh<double>& mesh, size_t triangles,
+                   double area) {
+  assert(mesh.trianglesCount() == triangles);
+  double total = 0;
+  for (size_t i = 0; i < mesh.trianglesCount(); ++i) {
+    const Point& a = mesh.vertices[mesh.indices[3 * i]];
+    const Point& b = mesh.vertices[mesh.indices[3 * i + 1]];
+    const Point& c = mesh.vertices[mesh.indices[3 * i + 2]];
+    assert(my::orient2d(a, b, c) > 0);
+    for (const Point& d : mesh.vertices) {
+      assert(my::incircle(a, b, c, d) <= 0);
+    }
+    total += mesh.triangle(i).area();
+  }
+  assert(std::abs(total - area) < 1e-9 * std::max(1., area));
+}
+
+void TestDelaunay() {
+  // 12 точек ровно на окружности радиуса 5: любая диагональ законна,
+  // но треугольников n - 2 и все описанные окружности совпадают
+  std::vector<Point> circle = {{5, 0},   {4, 3},   {3, 4},  {0, 5},
+                               {-3, 4},  {-4, 3},  {-5, 0}, {-4, -3},
+                               {-3, -4}, {0, -5},  {3, -4}, {4, -3}};
+  Polygon dodecagon(circle);
+  CheckDelaunay(my::delaunay(circle), 10, dodecagon.area());
+
+  // решётка: каждая клетка - четыре точки на одной окружности
+  std::vector<Point> grid;
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      grid.emplace_back(i, j);
+    }
+  }
+  CheckDelaunay(my::delaunay(grid), 2 * 81, 81);
+
+  // повторы не дают новых треугольников
+  std::vector<Point> doubled = grid;
+  doubled.insert(doubled.end(), grid.begin(), grid.end());
+  CheckDelaunay(my::delaunay(doubled), 2 * 81, 81);
+
+  // все точки на прямой и слишком мало точек - пустая сетка
+  std::vector<Point> line;
+  for (int i = 0; i < 20; ++i) {
+    line.emplace_back(i, 2 * i + 1);
+  }
+  CheckDelaunay(my::delaunay(line), 0, 0);
+  CheckDelaunay(my::delaunay(std::vector<Point>{{0, 0}, {1, 1}}), 0, 0);
+
+  // параллельная сборка по полосам даёт ту же триангуляцию по числу
+  // треугольников; решётка 40 x 40 проверяет вырожденные стыки полос
+  std::vector<Point> big_grid;
+  for (int i = 0; i < 40; ++i) {
+    for (int j = 0; j < 40; ++j) {
+      big_grid.emplace_back(i, j);
+    }
+  }
+  CheckDelaunay(my::delaunay(big_grid, 4), 2 * 39 * 39, 39 * 39);
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> coord(0, 1);
+  std::vector<Point> random;
+  for (int i = 0; i < 1000; ++i) {
+    random.emplace_back(coord(gen), coord(gen));
+  }
+  auto sequential = my::delaunay(random);
+  auto parallel = my::delaunay(random, 4);
+  double area = 0;
+  for (const auto& triangle : sequential.triangles()) {
+    area += triangle.area();
+  }
+  CheckDelaunay(sequential, sequential.trianglesCount(), area);
+  CheckDelaunay(parallel, sequential.trianglesCount(), area);
+}
+
+// Файл с заменёнными байтами: запись или заголовок, подделанные поверх
+// корректного файла.
+template <typename Value>
+void patch_file(const std::string& path, size_t offset, Value value) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(offset);
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool loads(const std::string& path) {
+  try {
+    my::MappedShapes<double> shapes(path);
+    return true;
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+}
+
+void TestMappedShapes() {
+  using Record = my::ShapeRecord<double>;
+  std::string path =
+      (std::filesystem::temp_directory_path() / "geometry_test.shp").string();
+
+  Polygon polygon(Point(0, 0), Point(4, 0), Point(4, 3), Point(1, 5));
+  Circle circle(Point(1, 1), 2);
+  auto write = [&]() { my::write_shapes<double>(path, {&polygon, &circle}); };
+
+  write();
+  {
+    my::MappedShapes<double> shapes(path);
+    assert(shapes.size() == 2);
+    assert(*shapes.shape(0) == polygon);
+    assert(*shapes.shape(1) == circle);
+    assert(shapes.containsPoint(1, Point(2, 2)));
+    assert(!shapes.containsPoint(0, Point(5, 5)));
+  }
+
+  const size_t second = sizeof(my::ShapeFileHeader) + sizeof(Record);
+  const size_t offset_field = offsetof(Record, offset);
+  const size_t type_field = offsetof(Record, type);
+  const size_t count_field = offsetof(Record, count);
+
+  // круг без координат в самом конце массива: circle(i) читал бы за ним
+  patch_file(path, second + offset_field, uint64_t(11));
+  patch_file(path, second + count_field, uint32_t(0));
+  assert(!loads(path));
+
+  // неизвестный тип
+  write();
+  patch_file(path, second + type_field, uint32_t(7));
+  assert(!loads(path));
+  write();
+  patch_file(path, second + type_field, uint32_t(0));
+  assert(!loads(path));
+
+  // offset + count переполняется и проходил бы проверку диапазона
+  write();
+  patch_file(path, second + offset_field, UINT64_MAX - 1);
+  assert(!loads(path));
+
+  // нечётное число координат и многоугольник из двух вершин
+  write();
+  patch_file(path, sizeof(my::ShapeFileHeader) + count_field, uint32_t(7));
+  assert(!loads(path));
+  write();
+  patch_file(path, sizeof(my::ShapeFileHeader) + count_field, uint32_t(4));
+  assert(!loads(path));
+
+  // запись другого типа с чужим числом координат
+  write();
+  patch_file(path, sizeof(my::ShapeFileHeader) + type_field,
+             uint32_t(my::ShapeType::Ellipse));
+  assert(!loads(path));
+
+  // заголовок: count * sizeof(Record) переполняется
+  write();
+  patch_file(path, offsetof(my::ShapeFileHeader, count), UINT64_MAX / 8);
+  assert(!loads(path));
+  write();
+  patch_file(path, offsetof(my::ShapeFileHeader, coords_count), UINT64_MAX / 4);
+  assert(!loads(path));
+
+  std::remove(path.c_str());
+}
+
+using Segment = BasicSegment<double>;
+
+std::vector<std::pair<size_t, size_t>> brute_intersections(
+    const std::vector<Segment>& segments) {
+  std::vector<std::pair<size_t, size_t>> ans;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    for (size_t j = i + 1; j < segments.size(); ++j) {
+      if (my::segments_intersect(segments[i], segments[j])) {
+        ans.emplace_back(i, j);
+      }
+    }
+  }
+  return ans;
+}
+
+void TestSegmentIntersections() {
+  using Pairs = std::vector<std::pair<size_t, size_t>>;
+  auto pairs = [](std::vector<Segment> segments) {
+    return my::segment_intersections(segments);
+  };
+
+  // крест, касание концом, общий конец
+  assert(pairs({{{0, 0}, {2, 2}}, {{0, 2}, {2, 0}}}) == Pairs({{0, 1}}));
+  assert(pairs({{{0, 0}, {2, 0}}, {{1, 0}, {1, 3}}}) == Pairs({{0, 1}}));
+  assert(pairs({{{0, 0}, {1, 1}}, {{1, 1}, {2, 0}}}) == Pairs({{0, 1}}));
+  // на одной прямой: наложение, стык концами, зазор
+  assert(pairs({{{0, 0}, {3, 3}}, {{1, 1}, {5, 5}}}) == Pairs({{0, 1}}));
+  assert(pairs({{{0, 0}, {1, 0}}, {{1, 0}, {2, 0}}}) == Pairs({{0, 1}}));
+  assert(pairs({{{0, 0}, {1, 0}}, {{2, 0}, {3, 0}}}).empty());
+  // вертикальные, почти параллельные и совпадающие
+  assert(pairs({{{1, 0}, {1, 5}}, {{1, 2}, {1, 7}}, {{0, 9}, {2, 9}}}) ==
+         Pairs({{0, 1}}));
+  assert(pairs({{{0, 0}, {1e9, 1}}, {{0, 1e-9}, {1e9, 1 + 1e-9}}}).empty());
+  assert(pairs({{{0, 0}, {4, 4}}, {{4, 4}, {0, 0}}}) == Pairs({{0, 1}}));
+  // пучок через одну точку
+  assert(pairs({{{-1, 0}, {1, 0}},
+                {{0, -1}, {0, 1}},
+                {{-1, -1}, {1, 1}},
+                {{-1, 1}, {1, -1}}}) ==
+         Pairs({{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}}));
+
+  // Мелкая решётка даёт сплошь вырожденные случаи: общие концы, касания,
+  // наложения, вертикали, отрезки нулевой длины. Ответ сверяется с
+  // перебором пар.
+  std::mt19937 gen(34);
+  std::uniform_int_distribution<int> small(0, 6);
+  std::uniform_real_distribution<double> wide(-1, 1);
+  for (int round = 0; round < 300; ++round) {
+    std::vector<Segment> segments;
+    for (int i = 0; i < 40; ++i) {
+      if (round % 2 == 0) {
+        segments.push_back({{double(small(gen)), double(small(gen))},
+                            {double(small(gen)), double(small(gen))}});
+      } else {
+        segments.push_back(
+            {{wide(gen), wide(gen)}, {wide(gen) * 1e-3, wide(gen)}});
+      }
+    }
+    assert(my::segment_intersections(segments) ==
+           brute_intersections(segments));
+  }
+}
+
+void TestIsSimple() {
+  assert(Polygon(Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1))
+             .isSimple());
+  // бабочка
+  assert(!Polygon(Point(0, 0), Point(1, 1), Point(1, 0), Point(0, 1))
+              .isSimple());
+  // вершина на чужом ребре
+  assert(!Polygon(Point(0, 0), Point(4, 0), Point(4, 4), Point(2, 0),
+                  Point(0, 4))
+              .isSimple());
+  // лишние вершины на прямой законны, возврат по той же прямой - нет
+  assert(Polygon(Point(0, 0), Point(1, 0), Point(2, 0), Point(2, 2),
+                 Point(0, 2))
+             .isSimple());
+  assert(!Polygon(Point(0, 0), Point(2, 0), Point(1, 0), Point(1, 2))
+              .isSimple());
+  // повтор вершины и касание двух несоседних вершин
+  assert(!Polygon(Point(0, 0), Point(1, 0), Point(1, 0), Point(0, 1))
+              .isSimple());
+  assert(!Polygon(Point(0, 0), Point(2, 0), Point(1, 1), Point(2, 2),
+                  Point(0, 2), Point(1, 1))
+              .isSimple());
+  // треугольник из точек на одной прямой складывается сам на себя
+  assert(!Polygon(Point(0, 0), Point(1, 1), Point(2, 2)).isSimple());
+
+  // звёздчатый многоугольник по кругу всегда простой
+  std::vector<Point> star;
+  for (int k = 0; k < 500; ++k) {
+    double angle = 2 * M_PI * k / 500;
+    double r = k % 2 == 0 ? 1 : 0.5;
+    star.emplace_back(r * std::cos(angle), r * std::sin(angle));
+  }
+  Polygon simple(star);
+  assert(simple.isSimple());
+  std::swap(star[10], star[250]);
+  assert(!Polygon(star).isSimple());
+}
+
+// SoAVertices против Polygon: те же вершины, площадь, периметр,
+// преобразования и принадлежность точки, в том числе на границе.
+void CheckSoA(const Polygon& polygon, const std::vector<Point>& queries) {
+  my::SoAVertices<double> soa = polygon.getSoAVertices();
+  std::vector<Point> vertices = polygon.getVertices();
+  assert(soa.size() == vertices.size());
+  assert(soa.points() == vertices);
+  for (size_t i = 0; i < soa.size(); ++i) {
+    assert(soa[i] == vertices[i]);
+  }
+  // продублированная первая вершина
+  assert(soa.x()[soa.size()] == vertices[0].x);
+  assert(soa.y()[soa.size()] == vertices[0].y);
+  assert(Polygon(soa).getVertices() == vertices);
+
+  double scale = polygon.perimeter();
+  assert(std::abs(soa.area() - polygon.area()) <= 1e-12 * scale * scale);
+  assert(std::abs(soa.perimeter() - polygon.perimeter()) <= 1e-12 * scale);
+  for (const Point& point : queries) {
+    assert(soa.containsPoint(point) == polygon.containsPoint(point));
+  }
+
+  Polygon moved = polygon;
+  my::SoAVertices<double> moved_soa = soa;
+  moved.rotate(Point(1, -2), 0.7);
+  moved_soa.rotate(Point(1, -2), 0.7);
+  moved.scale(Point(-3, 0.5), -1.5);
+  moved_soa.scale(Point(-3, 0.5), -1.5);
+  assert(moved_soa.points() == moved.getVertices());
+  assert(moved_soa.x()[moved_soa.size()] == moved_soa.x()[0]);
+  assert(moved_soa.y()[moved_soa.size()] == moved_soa.y()[0]);
+}
+
+void TestSoAVertices() {
+  my::SoAVertices<double> empty;
+  assert(empty.size() == 0 && empty.area() == 0 && empty.perimeter() == 0);
+  assert(!empty.containsPoint(Point(0, 0)));
+
+  // размеры вокруг числа параллельных сумм, с хвостом и без
+  std::mt19937 gen(28);
+  std::uniform_real_distribution<double> coord(-20, 20);
+  for (size_t n : {1, 3, 7, 8, 9, 16, 17, 100, 1001}) {
+    std::vector<Point> vertices;
+    for (size_t k = 0; k < n; ++k) {
+      double angle = 2 * M_PI * k / n;
+      double r = std::uniform_real_distribution<double>(5, 10)(gen);
+      vertices.emplace_back(r * std::cos(angle), r * std::sin(angle));
+    }
+    std::vector<Point> queries;
+    for (int i = 0; i < 2000; ++i) {
+      queries.emplace_back(coord(gen), coord(gen));
+    }
+    // вершины и точки на сторонах - в зоне неуверенности быстрого прохода
+    for (size_t k = 0; k < n; ++k) {
+      const Point& a = vertices[k];
+      const Point& b = vertices[(k + 1) % n];
+      queries.push_back(a);
+      queries.emplace_back(a.x + (b.x - a.x) / 2, a.y + (b.y - a.y) / 2);
+    }
+    CheckSoA(Polygon(vertices), queries);
+  }
+
+  // целые вершины: точки точно на сторонах, в вершинах, на продолжении
+  // стороны и на соседних ulp
+  Polygon comb(Point(0, 0), Point(6, 0), Point(6, 4), Point(4, 4),
+               Point(3, 1), Point(2, 4), Point(0, 4));
+  std::vector<Point> queries = {
+      Point(3, 0),  Point(6, 2), Point(5, 4), Point(3.5, 2.5), Point(3, 1),
+      Point(2.5, 2.5), Point(1, 4), Point(0, 2), Point(7, 0), Point(-1, 4),
+      Point(3, 2),  Point(3, 4), Point(1, 1), Point(0, 0), Point(6, 4)};
+  for (double x : {0.0, 3.0, 6.0}) {
+    queries.emplace_back(std::nextafter(x, -1.), 0);
+    queries.emplace_back(std::nextafter(x, 7.), 0);
+    queries.emplace_back(x, std::nextafter(0., 1.));
+    queries.emplace_back(x, std::nextafter(0., -1.));
+  }
+  queries.emplace_back(3.5, std::nextafter(2.5, 3.));
+  queries.emplace_back(3.5, std::nextafter(2.5, 2.));
+  CheckSoA(comb, queries);
+  my::SoAVertices<double> soa = comb.getSoAVertices();
+  assert(soa.containsPoint(Point(3, 0)) && soa.containsPoint(Point(3.5, 2.5)));
+  assert(!soa.containsPoint(Point(3, 2)) && !soa.containsPoint(Point(7, 0)));
+}
+
+void TestTriangleMetrics() {
+  std::mt19937 gen(30);
+  std::uniform_real_distribution<double> coord(-100, 100);
+  my::TriangleMesh<double> mesh;
+  for (int i = 0; i < 300; ++i) {
+    mesh.vertices.emplace_back(coord(gen), coord(gen));
+  }
+  std::uniform_int_distribution<uint32_t> index(0, 299);
+  while (mesh.indices.size() < 3 * 1000) {
+    uint32_t a = index(gen);
+    uint32_t b = index(gen);
+    uint32_t c = index(gen);
+    if (my::orient2d(mesh.vertices[a], mesh.vertices[b], mesh.vertices[c]) !=
+        0) {
+      mesh.indices.insert(mesh.indices.end(), {a, b, c});
+    }
+  }
+
+  auto metrics = my::triangle_metrics(mesh, 1);
+  auto parallel = my::triangle_metrics(mesh, 4);
+  assert(parallel.area == metrics.area && parallel.quality == metrics.quality);
+  auto close = [](double first, double second, double scale) {
+    return std::abs(first - second) <= 1e-6 * scale;
+  };
+  for (size_t i = 0; i < mesh.trianglesCount(); ++i) {
+    Triangle triangle = mesh.triangle(i);
+    Point out = triangle.outcenter();
+    Point in = triangle.inCenter();
+    Point ortho = triangle.orthocenter();
+    double R = triangle.circumscribedCircle().radius();
+    double r = triangle.inscribedCircle().radius();
+    double scale = 1 + R + std::abs(out.x) + std::abs(out.y);
+    assert(close(metrics.area[i], triangle.area(), scale * scale));
+    assert(close(metrics.circumcenter_x[i], out.x, scale));
+    assert(close(metrics.circumcenter_y[i], out.y, scale));
+    assert(close(metrics.circumradius[i], R, scale));
+    assert(close(metrics.incenter_x[i], in.x, scale));
+    assert(close(metrics.incenter_y[i], in.y, scale));
+    assert(close(metrics.inradius[i], r, scale));
+    assert(close(metrics.orthocenter_x[i], ortho.x, 10 * scale));
+    assert(close(metrics.orthocenter_y[i], ortho.y, 10 * scale));
+    assert(close(metrics.quality[i], 2 * r / R, 1));
+    assert(metrics.quality[i] > 0 && metrics.quality[i] <= 1 + 1e-12);
+  }
+
+  // правильный треугольник, затем вырожденные: на прямой, две и три
+  // совпавшие вершины
+  my::TriangleMesh<double> special;
+  special.vertices = {Point(0, 0), Point(2, 0), Point(1, std::sqrt(3.)),
+                      Point(4, 0), Point(5, 5)};
+  special.indices = {0, 1, 2, 0, 1, 3, 0, 0, 4, 4, 4, 4};
+  auto degenerate = my::triangle_metrics(special);
+  assert(std::abs(degenerate.quality[0] - 1) < 1e-12);
+  for (size_t i = 1; i < 4; ++i) {
+    assert(degenerate.area[i] == 0 && degenerate.inradius[i] == 0);
+    assert(degenerate.quality[i] == 0);
+    assert(std::isinf(degenerate.circumradius[i]));
+    assert(std::isnan(degenerate.circumcenter_x[i]));
+    assert(std::isnan(degenerate.orthocenter_y[i]));
+    assert(!std::isnan(degenerate.incenter_x[i]) &&
+           !std::isnan(degenerate.incenter_y[i]));
+  }
+  assert(degenerate.incenter_x[3] == 5 && degenerate.incenter_y[3] == 5);
+  // совпавшие A и B: инцентр в них
+  assert(degenerate.incenter_x[2] == 0 && degenerate.incenter_y[2] == 0);
+
+  assert(my::triangle_metrics(my::TriangleMesh<double>()).area.empty());
+}
+
+void TestScalarTypes() {
+  // длины и площади целых считаются в double, float остаётся float
+  static_assert(std::is_same_v<BasicPolygon<int>::real, double>);
+  static_assert(std::is_same_v<BasicPolygon<int64_t>::real, double>);
+  static_assert(std::is_same_v<BasicPolygon<float>::real, float>);
+  using IntPoint = BasicPoint<int>;
+  using FloatPoint = BasicPoint<float>;
+
+  // округление к ближайшему, половины - от нуля
+  using int_traits = my::scalar_traits<int>;
+  assert(int_traits::from_real(2.5) == 3 && int_traits::from_real(-2.5) == -3);
+  assert(int_traits::from_real(1.49) == 1 && int_traits::from_real(-0.4) == 0);
+  assert(my::scalar_traits<float>::from_real(0.1f) == 0.1f);
+
+  // предикаты точны: int32 и float переводятся в double без потерь
+  const int kBig = 1 << 30;
+  assert(my::orient2d(IntPoint(0, 0), IntPoint(3, 3), IntPoint(5, 5)) == 0);
+  assert(my::orient2d(IntPoint(0, 0), IntPoint(3, 3), IntPoint(5, 6)) > 0);
+  assert(my::orient2d(IntPoint(-kBig, -kBig), IntPoint(kBig - 1, kBig),
+                      IntPoint(kBig, kBig + 1)) < 0);
+  assert(my::incircle(IntPoint(0, 0), IntPoint(2, 0), IntPoint(2, 2),
+                      IntPoint(0, 2)) == 0);
+  assert(my::incircle(IntPoint(0, 0), IntPoint(2, 0), IntPoint(2, 2),
+                      IntPoint(1, 1)) > 0);
+  FloatPoint a(0.1f, 0.1f);
+  FloatPoint b(0.2f, 0.2f);
+  FloatPoint c(0.3f, 0.3f);
+  double sign = my::orient2d(a, b, c);
+  assert(sign == my::orient2d(Point(a.x, a.y), Point(b.x, b.y),
+                              Point(c.x, c.y)));
+  assert(sign == -my::orient2d(b, a, c));
+
+  // площадь и периметр целого многоугольника - не округлённые
+  BasicPolygon<int> triangle(IntPoint(0, 0), IntPoint(3, 0), IntPoint(0, 3));
+  assert(triangle.area() == 4.5);
+  assert(std::abs(triangle.perimeter() - (6 + 3 * std::sqrt(2.))) < 1e-12);
+  BasicPolygon<float> float_square(FloatPoint(0, 0), FloatPoint(0.5f, 0),
+                                   FloatPoint(0.5f, 0.5f),
+                                   FloatPoint(0, 0.5f));
+  assert(float_square.area() == 0.25f && float_square.perimeter() == 2.f);
+
+  // принадлежность: граница входит, соседняя целая точка - нет
+  assert(triangle.containsPoint(IntPoint(1, 1)));
+  assert(triangle.containsPoint(IntPoint(1, 2)));
+  assert(triangle.containsPoint(IntPoint(3, 0)));
+  assert(!triangle.containsPoint(IntPoint(2, 2)));
+  assert(!triangle.containsPoint(IntPoint(-1, 0)));
+  assert(float_square.containsPoint(FloatPoint(0.25f, 0.5f)));
+  assert(!float_square.containsPoint(
+      FloatPoint(0.25f, std::nextafter(0.5f, 1.f))));
+  BasicCircle<int> circle(IntPoint(0, 0), 5);
+  assert(circle.containsPoint(IntPoint(3, 4)));
+  assert(!circle.containsPoint(IntPoint(4, 4)));
+
+  // повороты и масштаб целых округляются обратно в сетку
+  BasicPolygon<int> square(IntPoint(0, 0), IntPoint(10, 0), IntPoint(10, 10),
+                           IntPoint(0, 10));
+  square.rotate(IntPoint(0, 0), M_PI / 2);
+  assert(square.getVertices() ==
+         (std::vector<IntPoint>{IntPoint(0, 0), IntPoint(0, 10),
+                                IntPoint(-10, 10), IntPoint(-10, 0)}));
+  square.rotate(IntPoint(0, 0), M_PI / 4);
+  assert(square.getVertices()[1] == IntPoint(-7, 7));
+  BasicPolygon<int> halved(IntPoint(3, 0), IntPoint(0, 5), IntPoint(-3, -1));
+  halved.scale(IntPoint(0, 0), 0.5);
+  assert(halved.getVertices() ==
+         (std::vector<IntPoint>{IntPoint(2, 0), IntPoint(0, 3),
+                                IntPoint(-2, -1)}));
+  assert(halved.boundingBox().max_y == 3);
+
+  // центр наименьшего круга округляется, радиус растёт на сдвиг
+  std::vector<IntPoint> pair = {IntPoint(0, 0), IntPoint(1, 0)};
+  BasicCircle<int> enclosing = my::min_enclosing_circle(pair);
+  assert(enclosing.center() == IntPoint(1, 0) && enclosing.radius() == 1);
+  for (const IntPoint& point : pair) {
+    assert(enclosing.containsPoint(point));
+  }
+
+  BasicEllipse<float> ellipse(FloatPoint(-3, 0), FloatPoint(3, 0), 10);
+  static_assert(std::is_same_v<decltype(ellipse.area()), float>);
+  assert(std::abs(ellipse.perimeter(my::Precision::Exact) -
+                  my::ellipse_perimeter(5.0, 4.0, my::Precision::Exact)) <
+         1e-4);
+  assert(ellipse.containsPoint(FloatPoint(5, 0)));
+  assert(!ellipse.containsPoint(FloatPoint(0, 4.01f)));
+}
+
+// classify по сетке против полного перебора containsPoint.
+void CheckClassify(const std::vector<const Shape*>& shapes,
+                   const std::vector<Point>& points) {
+  my::ShapeIndex<double> index(shapes);
+  my::Classification single = index.classify(points, 1);
+  my::Classification parallel = my::classify(points, shapes, 4);
+  assert(single.size() == points.size());
+  assert(parallel.offsets == single.offsets &&
+         parallel.shapes == single.shapes);
+  for (size_t i = 0; i < points.size(); ++i) {
+    std::vector<uint32_t> expected;
+    for (size_t j = 0; j < shapes.size(); ++j) {
+      if (shapes[j]->containsPoint(points[i])) {
+        expected.push_back(j);
+      }
+    }
+    assert(std::vector<uint32_t>(single.begin(i), single.end(i)) == expected);
+  }
+}
+
+void TestClassify() {
+  std::mt19937 gen(33);
+  std::uniform_real_distribution<double> coord(0, 100);
+  std::uniform_real_distribution<double> size(1, 10);
+  std::uniform_real_distribution<double> unit(-1, 1);
+
+  std::vector<std::unique_ptr<Shape>> owned;
+  std::vector<Point> points;
+  for (int i = 0; i < 400; ++i) {
+    Point center(coord(gen), coord(gen));
+    double r = size(gen);
+    switch (i % 5) {
+      case 0:
+        owned.push_back(std::make_unique<Circle>(center, r));
+        points.emplace_back(center.x + r, center.y);
+        break;
+      case 1: {
+        Point focus(center.x + r * unit(gen), center.y + r * unit(gen));
+        owned.push_back(std::make_unique<Ellipse>(center, focus, 3 * r));
+        break;
+      }
+      case 2:
+        owned.push_back(std::make_unique<Rectangle>(
+            center, Point(center.x + r, center.y + r), unit(gen)));
+        break;
+      case 3:
+        owned.push_back(std::make_unique<Triangle>(
+            center, Point(center.x + r, center.y + r * unit(gen)),
+            Point(center.x + r * unit(gen), center.y + r)));
+        break;
+      default: {
+        std::vector<Point> vertices;
+        for (int k = 0; k < 12; ++k) {
+          double angle = 2 * M_PI * k / 12;
+          double len = r * (0.5 + (unit(gen) + 1) / 4);
+          vertices.emplace_back(center.x + len * std::cos(angle),
+                                center.y + len * std::sin(angle));
+        }
+        owned.push_back(std::make_unique<Polygon>(vertices));
+      }
+    }
+    // вершины и середины сторон многоугольников - точки на границе
+    if (auto* polygon = dynamic_cast<const Polygon*>(owned.back().get())) {
+      std::vector<Point> vertices = polygon->getVertices();
+      for (size_t k = 0, prev = vertices.size() - 1; k < vertices.size();
+           prev = k++) {
+        points.push_back(vertices[k]);
+        points.emplace_back((vertices[prev].x + vertices[k].x) / 2,
+                            (vertices[prev].y + vertices[k].y) / 2);
+      }
+    }
+  }
+
+  // Тонкие эллипсы (b = 1e-8): containsPoint принимает d1 + d2 <= 2a +
+  // accuracy, а это поперёк оси до sqrt(a accuracy) ~ 2e-3, много больше
+  // b и запаса kPad. Горизонтальный, вертикальный и наклонный.
+  for (auto [dx, dy] : {std::pair{1., 0.}, {0., 1.}, {0.6, 0.8}}) {
+    Point center(coord(gen), coord(gen));
+    double a = 5;
+    double c = std::sqrt(a * a - 1e-16);
+    owned.push_back(std::make_unique<Ellipse>(
+        Point(center.x - c * dx, center.y - c * dy),
+        Point(center.x + c * dx, center.y + c * dy), 2 * a));
+    assert(owned.back()->containsPoint(
+        Point(center.x - dy * 2e-3, center.y + dx * 2e-3)));
+    for (double shift : {0.0, 3e-7, 2e-6, 1e-3, 2.2e-3, 3e-3}) {
+      // поперёк в середине и на полпути к вершине, вдоль за вершиной
+      points.emplace_back(center.x - dy * shift, center.y + dx * shift);
+      points.emplace_back(center.x + a * dx * 0.5 - dy * shift,
+                          center.y + a * dy * 0.5 + dx * shift);
+      points.emplace_back(center.x + (a + shift) * dx,
+                          center.y + (a + shift) * dy);
+    }
+  }
+
+  for (int i = 0; i < 20000; ++i) {
+    points.emplace_back(coord(gen), coord(gen));
+  }
+
+  std::vector<const Shape*> shapes;
+  for (const auto& shape : owned) {
+    shapes.push_back(shape.get());
+  }
+  CheckClassify(shapes, points);
+
+  // одна фигура, фигуры без точек и точки без фигур
+  CheckClassify({shapes[0]}, points);
+  CheckClassify({shapes.back()}, points);
+  CheckClassify(shapes, {});
+  my::Classification none = my::classify(points, {}, 2);
+  assert(none.size() == points.size() && none.shapes.empty());
+}
+
+// Наименьший круг перебором: он проходит через две или три точки.
+double brute_enclosing_radius(const std::vector<Point>& points) {
+  double best = INFINITY;
+  auto consider = [&](double x, double y, double r) {
+    for (const Point& point : points) {
+      if (std::hypot(point.x - x, point.y - y) > r * (1 + 1e-12) + 1e-12) {
+        return;
+      }
+    }
+    best = std::min(best, r);
+  };
+  for (size_t i = 0; i < points.size(); ++i) {
+    consider(points[i].x, points[i].y, 0);
+    for (size_t j = i + 1; j < points.size(); ++j) {
+      consider((points[i].x + points[j].x) / 2,
+               (points[i].y + points[j].y) / 2,
+               points[i].distance(points[j]) / 2);
+      for (size_t k = j + 1; k < points.size(); ++k) {
+        Triangle triangle(points[i], points[j], points[k]);
+        if (my::orient2d(points[i], points[j], points[k]) != 0) {
+          Point center = triangle.outcenter();
+          consider(center.x, center.y, center.distance(points[i]));
+        }
+      }
+    }
+  }
+  return best;
+}
+
+// Точки границы лежат в коробке и круге фигуры.
+void CheckBounds(const Shape& shape, const std::vector<Point>& boundary) {
+  my::BoundingBox<double> box = shape.boundingBox();
+  Circle circle = shape.boundingCircle();
+  double tolerance = 1e-9 * (1 + circle.radius());
+  my::BoundingBox<double> padded = {box.min_x - tolerance,
+                                    box.min_y - tolerance,
+                                    box.max_x + tolerance,
+                                    box.max_y + tolerance};
+  for (const Point& point : boundary) {
+    assert(padded.contains(point));
+    assert(circle.center().distance(point) <= circle.radius() + tolerance);
+    assert(shape.containsPoint(point));
+  }
+}
+
+void TestBoundingShapes() {
+  // известные наименьшие круги
+  Circle square = my::min_enclosing_circle(std::vector<Point>{
+      Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2), Point(1, 1)});
+  assert(square.center() == Point(1, 1));
+  assert(std::abs(square.radius() - std::sqrt(2.)) < 1e-12);
+  // тупоугольный: круг на длинной стороне, а не описанный
+  Circle obtuse = my::min_enclosing_circle(
+      std::vector<Point>{Point(0, 0), Point(4, 0), Point(1, 1)});
+  assert(obtuse.center() == Point(2, 0));
+  assert(std::abs(obtuse.radius() - 2) < 1e-12);
+  Circle equilateral = my::min_enclosing_circle(std::vector<Point>{
+      Point(0, 0), Point(2, 0), Point(1, std::sqrt(3.))});
+  assert(equilateral.center() == Point(1, 1 / std::sqrt(3.)));
+  assert(std::abs(equilateral.radius() - 2 / std::sqrt(3.)) < 1e-12);
+  Circle point = my::min_enclosing_circle(std::vector<Point>{Point(5, -1)});
+  assert(point.center() == Point(5, -1) && point.radius() == 0);
+  Circle segment = my::min_enclosing_circle(std::vector<Point>{
+      Point(0, 0), Point(1, 1), Point(3, 3), Point(3, 3), Point(2, 2)});
+  assert(segment.center() == Point(1.5, 1.5));
+  assert(std::abs(segment.radius() - 1.5 * std::sqrt(2.)) < 1e-12);
+  bool thrown = false;
+  try {
+    my::min_enclosing_circle(std::vector<Point>());
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::mt19937 gen(36);
+  std::uniform_real_distribution<double> coord(-50, 50);
+  for (size_t n : {2, 3, 5, 10, 30}) {
+    std::vector<Point> points(n);
+    for (auto& cnt : points) {
+      cnt = Point(coord(gen), coord(gen));
+    }
+    Circle circle = my::min_enclosing_circle(points);
+    for (const Point& cnt : points) {
+      assert(circle.center().distance(cnt) <= circle.radius() * (1 + 1e-12));
+    }
+    double brute = brute_enclosing_radius(points);
+    assert(std::abs(circle.radius() - brute) <= 1e-9 * brute);
+  }
+
+  // коробка и круг накрывают границу каждой фигуры
+  Polygon polygon(Point(0, 0), Point(5, 1), Point(2, 2), Point(4, 6),
+                  Point(-1, 3));
+  CheckBounds(polygon, polygon.getVertices());
+  my::BoundingBox<double> box = polygon.boundingBox();
+  assert(box.min_x == -1 && box.min_y == 0 && box.max_x == 5 &&
+         box.max_y == 6);
+  // сдвиг вершин обновляет коробку
+  polygon.scale(Point(0, 0), 2);
+  assert(polygon.boundingBox().max_y == 12);
+  CheckBounds(polygon, polygon.getVertices());
+
+  Rectangle rectangle(Point(0, 0), Point(4, 3), 0.5);
+  CheckBounds(rectangle, rectangle.getVertices());
+  assert(std::abs(rectangle.boundingCircle().radius() - 2.5) < 1e-12);
+  Triangle triangle(Point(0, 0), Point(4, 0), Point(1, 1));
+  CheckBounds(triangle, triangle.getVertices());
+  assert(std::abs(triangle.boundingCircle().radius() - 2) < 1e-12);
+
+  Circle circle(Point(1, 2), 3);
+  Ellipse ellipse(Point(-2, -1), Point(3, 2), 8);
+  Ellipse rotated = ellipse;
+  rotated.rotate(Point(0, 0), 1);
+  for (const Ellipse& cnt : {ellipse, rotated}) {
+    // граница: центр + a cos t u + b sin t v, u вдоль фокусов
+    auto [first, second] = cnt.focuses();
+    Point center((first.x + second.x) / 2, (first.y + second.y) / 2);
+    double length = first.distance(second);
+    double ux = (second.x - first.x) / length;
+    double uy = (second.y - first.y) / length;
+    double a = cnt.semiMajorAxis();
+    double b = cnt.semiMinorAxis();
+    std::vector<Point> boundary;
+    for (int i = 0; i < 1024; ++i) {
+      double t = 2 * M_PI * i / 1024;
+      boundary.emplace_back(center.x + a * std::cos(t) * ux -
+                                b * std::sin(t) * uy,
+                            center.y + a * std::cos(t) * uy +
+                                b * std::sin(t) * ux);
+    }
+    CheckBounds(cnt, boundary);
+    // коробка плотная: граница доходит до каждой её стороны
+    my::BoundingBox<double> bounds = cnt.boundingBox();
+    double min_x = INFINITY;
+    double max_y = -INFINITY;
+    for (const Point& cnt_point : boundary) {
+      min_x = std::min(min_x, cnt_point.x);
+      max_y = std::max(max_y, cnt_point.y);
+    }
+    assert(min_x - bounds.min_x < 1e-4 && bounds.max_y - max_y < 1e-4);
+    assert(std::abs(cnt.boundingCircle().radius() - a) < 1e-12);
+  }
+  std::vector<Point> round;
+  for (int i = 0; i < 64; ++i) {
+    round.emplace_back(1 + 3 * std::cos(i * M_PI / 32),
+                       2 + 3 * std::sin(i * M_PI / 32));
+  }
+  CheckBounds(circle, round);
+
+  // отсев в containsPoint не меняет ответа: сравнение с определением
+  std::uniform_real_distribution<double> near(-6, 8);
+  for (int i = 0; i < 20000; ++i) {
+    Point cnt(near(gen), near(gen));
+    auto [first, second] = ellipse.focuses();
+    bool inside = first.distance(cnt) + second.distance(cnt) <= 8 + 1e-6;
+    assert(ellipse.containsPoint(cnt) == inside);
+
+    bool crossing = false;
+    std::vector<Point> vertices = polygon.getVertices();
+    for (size_t j = 0, prev = vertices.size() - 1; j < vertices.size();
+         prev = j++) {
+      const Point& a = vertices[prev];
+      const Point& b = vertices[j];
+      if ((a.y > cnt.y) != (b.y > cnt.y) &&
+          cnt.x < a.x + (cnt.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+        crossing = !crossing;
+      }
+    }
+    assert(polygon.containsPoint(cnt) == crossing);
+  }
+  // вершины и середины сторон - на границе
+  std::vector<Point> vertices = polygon.getVertices();
+  for (size_t j = 0, prev = vertices.size() - 1; j < vertices.size();
+       prev = j++) {
+    assert(polygon.containsPoint(vertices[j]));
+    Point middle((vertices[prev].x + vertices[j].x) / 2,
+                 (vertices[prev].y + vertices[j].y) / 2);
+    assert(polygon.containsPoint(middle));
+  }
+  assert(!polygon.containsPoint(Point(100, 100)));
+  assert(!ellipse.containsPoint(Point(100, 100)));
+
+  // isCongruentTo: отсев по периметру и радиусу не отбрасывает равные
+  Polygon base(Point(0, 0), Point(4, 0), Point(5, 3), Point(1, 2));
+  Polygon moved = base;
+  moved.rotate(Point(2, 7), 2.5);
+  moved.reflect(Line(Point(0, 1), Point(1, 3)));
+  std::vector<Point> shifted = moved.getVertices();
+  std::rotate(shifted.begin(), shifted.begin() + 2, shifted.end());
+  assert(base.isCongruentTo(moved));
+  assert(base.isCongruentTo(Polygon(shifted)));
+  std::reverse(shifted.begin(), shifted.end());
+  assert(base.isCongruentTo(Polygon(shifted)));
+  // другой периметр
+  Polygon longer(Point(0, 0), Point(4, 0), Point(5, 3), Point(1, 3));
+  assert(!base.isCongruentTo(longer));
+  // тот же периметр 8, другой радиус
+  Polygon thin(Point(0, 0), Point(3, 0), Point(3, 1), Point(0, 1));
+  Polygon wide(Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2));
+  assert(!thin.isCongruentTo(wide));
+  // тот же периметр и радиус, но не равны: вписанные пятиугольники с
+  // теми же сторонами в другом порядке проходят отсев до перебора
+  auto inscribed = [](std::vector<double> degrees) {
+    std::vector<Point> ans;
+    double angle = 0;
+    for (double cnt : degrees) {
+      ans.emplace_back(5 * std::cos(angle), 5 * std::sin(angle));
+      angle += cnt * M_PI / 180;
+    }
+    return Polygon(ans);
+  };
+  Polygon adjacent = inscribed({60, 60, 80, 80, 80});
+  assert(!adjacent.isCongruentTo(inscribed({60, 80, 60, 80, 80})));
+  assert(adjacent.isCongruentTo(inscribed({80, 60, 60, 80, 80})));
+  // обход в обратную сторону совпадает только в первой вершине: раньше
+  // цикл обрывался на первом несовпадении прямого обхода
+  Polygon triangle_abc(Point(0, 0), Point(1, 0), Point(0, 1));
+  assert(!(triangle_abc == Polygon(Point(0, 0), Point(0, 1), Point(5, 5))));
+  assert(triangle_abc == Polygon(Point(0, 1), Point(1, 0), Point(0, 0)));
+  Polygon bigger = base;
+  bigger.scale(Point(1, 1), 3);
+  assert(base.isSimilarTo(bigger) && !base.isCongruentTo(bigger));
+}
+
+// Оболочка без повторов, строго против часовой стрелки, из входных
+// точек и содержит их все.
+void CheckHull(const std::vector<Point>& points,
+               const std::vector<Point>& hull) {
+  size_t n = hull.size();
+  for (size_t i = 0; i < n; ++i) {
+    assert(std::find(points.begin(), points.end(), hull[i]) != points.end());
+    if (n >= 3) {
+      assert(my::orient2d(hull[i], hull[(i + 1) % n], hull[(i + 2) % n]) >
+             0);
+    }
+  }
+  for (const Point& point : points) {
+    if (n == 1) {
+      assert(point == hull[0]);
+    }
+    for (size_t i = 0; n >= 3 && i < n; ++i) {
+      assert(my::orient2d(hull[i], hull[(i + 1) % n], point) >= 0);
+    }
+  }
+}
+
+// Перебором: наименьшие по площади и по полупериметру прямоугольники со
+// стороной вдоль прямой через две точки; среди них есть оптимальный.
+std::pair<double, double> brute_rectangles(const std::vector<Point>& points) {
+  double area = INFINITY;
+  double half_perimeter = INFINITY;
+  for (const Point& from : points) {
+    for (const Point& to : points) {
+      double len = from.distance(to);
+      if (len == 0) {
+        continue;
+      }
+      double ux = (to.x - from.x) / len;
+      double uy = (to.y - from.y) / len;
+      double lo = INFINITY;
+      double hi = -INFINITY;
+      double bottom = INFINITY;
+      double top = -INFINITY;
+      for (const Point& point : points) {
+        double along = point.x * ux + point.y * uy;
+        double across = point.y * ux - point.x * uy;
+        lo = std::min(lo, along);
+        hi = std::max(hi, along);
+        bottom = std::min(bottom, across);
+        top = std::max(top, across);
+      }
+      area = std::min(area, (hi - lo) * (top - bottom));
+      half_perimeter = std::min(half_perimeter, hi - lo + top - bottom);
+    }
+  }
+  return {area, half_perimeter};
+}
+
+// Прямоугольник действительно прямоугольник и накрывает все точки.
+void CheckRectangle(const Rectangle& rectangle,
+                    const std::vector<Point>& points) {
+  std::vector<Point> corners = rectangle.getVertices();
+  double scale = rectangle.perimeter();
+  for (size_t i = 0; i < 4; ++i) {
+    const Point& a = corners[i];
+    const Point& b = corners[(i + 1) % 4];
+    const Point& c = corners[(i + 2) % 4];
+    double dot = (b.x - a.x) * (c.x - b.x) + (b.y - a.y) * (c.y - b.y);
+    assert(std::abs(dot) <= 1e-9 * scale * scale);
+  }
+  double sign = my::orient2d(corners[0], corners[1], corners[2]) > 0 ? 1 : -1;
+  for (const Point& point : points) {
+    for (size_t i = 0; i < 4; ++i) {
+      const Point& a = corners[i];
+      const Point& b = corners[(i + 1) % 4];
+      double cross = (b.x - a.x) * (point.y - a.y) -
+                     (b.y - a.y) * (point.x - a.x);
+      assert(sign * cross / a.distance(b) >= -1e-9 * scale);
+    }
+  }
+}
+
+void CheckCalipers(const std::vector<Point>& vertices) {
+  Polygon polygon(vertices);
+  CheckHull(vertices, my::convex_hull(vertices));
+
+  double diameter = 0;
+  for (const Point& a : vertices) {
+    for (const Point& b : vertices) {
+      diameter = std::max(diameter, a.distance(b));
+    }
+  }
+  auto [first, second] = my::diameter(polygon);
+  assert(std::abs(first.distance(second) - diameter) <= 1e-9 * diameter);
+
+  // ширина - наименьшая по опорным прямым через две точки высота
+  double width = INFINITY;
+  for (const Point& a : vertices) {
+    for (const Point& b : vertices) {
+      double len = a.distance(b);
+      if (len == 0) {
+        continue;
+      }
+      double height = 0;
+      bool support = true;
+      for (const Point& point : vertices) {
+        double cross = my::orient2d(a, b, point);
+        support = support && cross >= 0;
+        height = std::max(height, cross / len);
+      }
+      if (support) {
+        width = std::min(width, height);
+      }
+    }
+  }
+  assert(std::abs(my::width(polygon) - width) <= 1e-9 * diameter);
+
+  auto [area, half_perimeter] = brute_rectangles(vertices);
+  Rectangle by_area = my::min_area_rectangle(polygon);
+  Rectangle by_perimeter = my::min_perimeter_rectangle(polygon);
+  CheckRectangle(by_area, vertices);
+  CheckRectangle(by_perimeter, vertices);
+  assert(std::abs(by_area.area() - area) <= 1e-9 * diameter * diameter);
+  assert(std::abs(by_perimeter.perimeter() - 2 * half_perimeter) <=
+         1e-9 * diameter);
+}
+
+void CheckClosestPair(const std::vector<Point>& points) {
+  double best = INFINITY;
+  for (size_t i = 0; i < points.size(); ++i) {
+    for (size_t j = i + 1; j < points.size(); ++j) {
+      best = std::min(best, points[i].distance(points[j]));
+    }
+  }
+  auto [first, second] = my::closest_pair(points);
+  assert(first.distance(second) == best);
+}
+
+void TestCalipers() {
+  bool thrown = false;
+  try {
+    my::diameter(Polygon());
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(my::width(Polygon()) == 0);
+
+  Point single(2, 3);
+  auto [first, second] = my::diameter(Polygon(single));
+  assert(first == single && second == single);
+
+  Polygon square(Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2));
+  auto [a, b] = my::diameter(square);
+  assert(std::abs(a.distance(b) - 2 * std::sqrt(2.)) < 1e-12);
+  assert(std::abs(my::width(square) - 2) < 1e-12);
+  assert(std::abs(my::min_area_rectangle(square).area() - 4) < 1e-12);
+
+  std::mt19937 gen(35);
+  std::uniform_real_distribution<double> coord(-100, 100);
+  for (size_t n : {3, 4, 7, 20, 50}) {
+    std::vector<Point> points(n);
+    for (auto& point : points) {
+      point = Point(coord(gen), coord(gen));
+    }
+    // выпуклый в обоих обходах
+    std::vector<Point> hull = my::convex_hull(points);
+    CheckCalipers(hull);
+    std::reverse(hull.begin(), hull.end());
+    CheckCalipers(hull);
+
+    // звёздный, обычно невыпуклый
+    std::vector<double> angles(n);
+    for (double& angle : angles) {
+      angle = std::uniform_real_distribution<double>(0, 2 * M_PI)(gen);
+    }
+    std::sort(angles.begin(), angles.end());
+    std::vector<Point> star;
+    for (double angle : angles) {
+      double radius = std::uniform_real_distribution<double>(10, 100)(gen);
+      star.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    CheckCalipers(star);
+    CheckClosestPair(points);
+  }
+
+  // повторы вершин и вершины на сторонах
+  std::vector<Point> repeated = {Point(0, 0), Point(0, 0), Point(1, 0),
+                                 Point(3, 0), Point(3, 0), Point(3, 2),
+                                 Point(1, 2), Point(0, 2), Point(0, 1)};
+  CheckCalipers(repeated);
+  assert(my::convex_hull(repeated).size() == 4);
+
+  // все точки на одной прямой: оболочка - два конца, ширина 0, а
+  // прямоугольника нет
+  std::vector<Point> collinear = {Point(1, 1), Point(3, 3), Point(2, 2),
+                                  Point(0, 0), Point(3, 3)};
+  std::vector<Point> segment = my::convex_hull(collinear);
+  assert(segment.size() == 2);
+  assert(segment[0] == Point(0, 0) && segment[1] == Point(3, 3));
+  auto [begin, end] = my::diameter(Polygon(collinear));
+  assert(std::abs(begin.distance(end) - 3 * std::sqrt(2.)) < 1e-12);
+  assert(my::width(Polygon(collinear)) == 0);
+  thrown = false;
+  try {
+    my::min_area_rectangle(Polygon(collinear));
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // ближайшая пара: совпадающие точки, решётка, прямая
+  std::vector<Point> grid;
+  for (int x = 0; x < 12; ++x) {
+    for (int y = 0; y < 12; ++y) {
+      grid.emplace_back(x * 3, y * 2);
+    }
+  }
+  CheckClosestPair(grid);
+  CheckClosestPair(collinear);
+  grid.push_back(Point(9, 8));
+  auto [left, right] = my::closest_pair(grid);
+  assert(left == right && left == Point(9, 8));
+  thrown = false;
+  try {
+    my::closest_pair(std::vector<Point>{single});
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+int main() {
+  std::cerr << "Starting tests" << std::endl;
+  TestPointEquality();
+  std::cerr << "TestPointEquality passed" << std::endl;
+  TestEllipsePerimeter();
+  std::cerr << "TestEllipsePerimeter passed" << std::endl;
+  TestDelaunay();
+  std::cerr << "TestDelaunay passed" << std::endl;
+  TestMappedShapes();
+  std::cerr << "TestMappedShapes passed" << std::endl;
+  TestSegmentIntersections();
+  std::cerr << "TestSegmentIntersections passed" << std::endl;
+  TestIsSimple();
+  std::cerr << "TestIsSimple passed" << std::endl;
+  TestCalipers();
+  std::cerr << "TestCalipers passed" << std::endl;
+  TestBoundingShapes();
+  std::cerr << "TestBoundingShapes passed" << std::endl;
+  TestTriangleMetrics();
+  std::cerr << "TestTriangleMetrics passed" << std::endl;
+  TestSoAVertices();
+  std::cerr << "TestSoAVertices passed" << std::endl;
+  TestScalarTypes();
+  std::cerr << "TestScalarTypes passed" << std::endl;
+  TestClassify();
+  std::cerr << "TestClassify passed" << std::endl;
+  std::cout << 0;
+}
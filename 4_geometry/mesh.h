@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "geometry.h"
+#include "parallel.h"
+
+namespace my {
+// Индексированная треугольная сетка: буфер вершин и буфер индексов, по три
+// индекса на треугольник.
+template <typename T>
+struct TriangleMesh {
+  std::vector<BasicPoint<T>> vertices;
+  std::vector<uint32_t> indices;
+
+  size_t trianglesCount() const {
+    return indices.size() / 3;
+  }
+
+  BasicTriangle<T> triangle(size_t i) const {
+    return BasicTriangle<T>(vertices[indices[3 * i]],
+                            vertices[indices[3 * i + 1]],
+                            vertices[indices[3 * i + 2]]);
+  }
+
+  std::vector<BasicTriangle<T>> triangles() const {
+    std::vector<BasicTriangle<T>> ans;
+    ans.reserve(trianglesCount());
+    for (size_t i = 0; i < trianglesCount(); ++i) {
+      ans.push_back(triangle(i));
+    }
+    return ans;
+  }
+};
+
+// Результаты пакетного расчёта, по массиву на величину (структура массивов).
+// quality = 2r / R: 1 у правильного треугольника, 0 у вырожденного.
+// У вырожденного (вершины на одной прямой или совпали) описанной
+// окружности нет: circumradius - бесконечность, её центр и ортоцентр -
+// NaN. Если совпали все три вершины, инцентр - эта точка.
+template <typename real>
+struct TriangleMeshMetrics {
+  std::vector<real> area;
+  std::vector<real> circumcenter_x;
+  std::vector<real> circumcenter_y;
+  std::vector<real> circumradius;
+  std::vector<real> incenter_x;
+  std::vector<real> incenter_y;
+  std::vector<real> inradius;
+  std::vector<real> orthocenter_x;
+  std::vector<real> orthocenter_y;
+  std::vector<real> quality;
+
+  void resize(size_t size) {
+    for (auto* field : {&area, &circumcenter_x, &circumcenter_y,
+                        &circumradius, &incenter_x, &incenter_y, &inradius,
+                        &orthocenter_x, &orthocenter_y, &quality}) {
+      field->resize(size);
+    }
+  }
+};
+
+namespace detail {
+template <typename T, typename real>
+void triangle_metrics(const TriangleMesh<T>& mesh,
+                      TriangleMeshMetrics<real>& ans, size_t begin,
+                      size_t end) {
+  const BasicPoint<T>* vertices = mesh.vertices.data();
+  const uint32_t* indices = mesh.indices.data();
+
+  // Всё считается в координатах относительно первой вершины: так меньше
+  // потеря точности, а стороны, площадь и центры делят общие величины.
+  for (size_t i = begin; i < end; ++i) {
+    const BasicPoint<T>& A = vertices[indices[3 * i]];
+    const BasicPoint<T>& B = vertices[indices[3 * i + 1]];
+    const BasicPoint<T>& C = vertices[indices[3 * i + 2]];
+
+    real bx = real(B.x) - real(A.x);
+    real by = real(B.y) - real(A.y);
+    real cx = real(C.x) - real(A.x);
+    real cy = real(C.y) - real(A.y);
+
+    real b_len2 = bx * bx + by * by;
+    real c_len2 = cx * cx + cy * cy;
+    real bc_len2 = (cx - bx) * (cx - bx) + (cy - by) * (cy - by);
+
+    real side_ab = std::sqrt(b_len2);
+    real side_ac = std::sqrt(c_len2);
+    real side_bc = std::sqrt(bc_len2);
+    real perimeter = side_ab + side_ac + side_bc;
+
+    real cross = bx * cy - by * cx;
+    real area = std::abs(cross) / 2;
+    // выбор, а не ветвление: цикл остаётся векторизуемым
+    bool degenerate = cross == 0;
+    real nan = std::numeric_limits<real>::quiet_NaN();
+
+    real ux = degenerate ? nan : (cy * b_len2 - by * c_len2) / (2 * cross);
+    real uy = degenerate ? nan : (bx * c_len2 - cx * b_len2) / (2 * cross);
+    real R = degenerate ? std::numeric_limits<real>::infinity()
+                        : std::sqrt(ux * ux + uy * uy);
+
+    // вершина напротив стороны входит в инцентр с её длиной как весом
+    real weight = perimeter > 0 ? 1 / perimeter : 0;
+    real ix = (side_ac * bx + side_ab * cx) * weight;
+    real iy = (side_ac * by + side_ab * cy) * weight;
+    real r = 2 * area * weight;
+
+    ans.area[i] = area;
+    ans.circumcenter_x[i] = real(A.x) + ux;
+    ans.circumcenter_y[i] = real(A.y) + uy;
+    ans.circumradius[i] = R;
+    ans.incenter_x[i] = real(A.x) + ix;
+    ans.incenter_y[i] = real(A.y) + iy;
+    ans.inradius[i] = r;
+    // H = A + B + C - 2O, в координатах относительно A
+    ans.orthocenter_x[i] = real(A.x) + bx + cx - 2 * ux;
+    ans.orthocenter_y[i] = real(A.y) + by + cy - 2 * uy;
+    ans.quality[i] = degenerate ? 0 : 2 * r / R;
+  }
+}
+}  // namespace detail
+
+// Считает все величины для всех треугольников за один проход. Центр
+// окружности девяти точек - середина OH, её радиус - R / 2, прямая Эйлера
+// проходит через O и H, поэтому отдельно они не хранятся.
+template <typename T>
+TriangleMeshMetrics<typename scalar_traits<T>::real_type> triangle_metrics(
+    const TriangleMesh<T>& mesh, size_t threads = default_threads()) {
+  using real = typename scalar_traits<T>::real_type;
+  const size_t kGrain = 1 << 14;
+
+  TriangleMeshMetrics<real> ans;
+  ans.resize(mesh.trianglesCount());
+
+  parallel_for(mesh.trianglesCount(), threads, kGrain,
+               [&](size_t begin, size_t end) {
+                 detail::triangle_metrics(mesh, ans, begin, end);
+               });
+  return ans;
+}
+}  // namespace my
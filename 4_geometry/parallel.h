@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace my {
+// Та же функция есть в 5_matrix/thread_pool.h; макрос даёт включать оба
+// заголовка вместе, inline - в нескольких единицах трансляции.
+#ifndef MY_DEFAULT_THREADS
+#define MY_DEFAULT_THREADS
+inline size_t default_threads() {
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+#endif
+
+// Вызывает func(begin, end) для кусков [0, count) длины не больше grain.
+// Куски раздаются через общий атомарный счётчик, поэтому поток, закончивший
+// раньше, забирает следующий кусок, а не ждёт остальных.
+template <typename Func>
+void parallel_for(size_t count, size_t threads, size_t grain, Func func) {
+  grain = std::max<size_t>(1, grain);
+  threads = std::max<size_t>(1, std::min(threads, (count + grain - 1) / grain));
+
+  if (threads == 1) {
+    for (size_t begin = 0; begin < count; begin += grain) {
+      func(begin, std::min(count, begin + grain));
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t begin = next.fetch_add(grain); begin < count;
+         begin = next.fetch_add(grain)) {
+      func(begin, std::min(count, begin + grain));
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (size_t i = 1; i < threads; ++i) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : pool) {
+    thread.join();
+  }
+}
+}  // namespace my
@@ -0,0 +1,437 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+
+// Бинарный формат коллекции фигур:
+//
+//   ShapeFileHeader                      (64 байта)
+//   ShapeRecord<T>[count]                по записи на фигуру
+//   T[coords_count]                      общий массив координат
+//
+// Запись хранит тип фигуры, её bbox и смещение своих чисел в общем массиве:
+// многоугольники - x0 y0 x1 y1 ..., круг - cx cy r, эллипс - фокусы и 2a.
+// Порядок байт - родной для машины, тип координат записан в заголовке.
+namespace my {
+enum class ShapeType : uint32_t {
+  Polygon = 1,
+  Rectangle = 2,
+  Square = 3,
+  Triangle = 4,
+  Circle = 5,
+  Ellipse = 6
+};
+
+struct ShapeFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t scalar;  // 'f' или 'i' << 8 | sizeof(T)
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t records_offset;
+  uint64_t coords_offset;
+  uint64_t coords_count;
+  uint64_t padding[2];
+};
+
+template <typename T>
+struct ShapeRecord {
+  uint64_t offset;
+  ShapeType type;
+  uint32_t count;  // число координат фигуры в общем массиве
+  T bbox[4];       // min_x, min_y, max_x, max_y
+};
+
+const char kShapeFileMagic[4] = {'S', 'H', 'P', 'B'};
+const uint32_t kShapeFileVersion = 1;
+
+template <typename T>
+constexpr uint32_t shape_file_scalar() {
+  return (std::is_integral_v<T> ? 'i' : 'f') << 8 | sizeof(T);
+}
+
+// Многоугольник прямо в отображённой памяти: ничего не копирует и не
+// выделяет, живёт пока жив MappedShapes.
+template <typename T>
+class PolygonView {
+ public:
+  using real = typename scalar_traits<T>::real_type;
+
+ private:
+  const T* coords_;
+  size_t size_;
+
+ public:
+  PolygonView(const T* coords, size_t size) : coords_(coords), size_(size) {}
+
+  size_t verticesCount() const {
+    return size_;
+  }
+
+  BasicPoint<T> operator[](size_t i) const {
+    return BasicPoint<T>(coords_[2 * i], coords_[2 * i + 1]);
+  }
+
+  real perimeter() const {
+    real ans = 0;
+    for (size_t i = 0, prev = size_ - 1; i < size_; prev = i++) {
+      ans += (*this)[prev].distance((*this)[i]);
+    }
+    return ans;
+  }
+
+  real area() const {
+    real ans = 0;
+    for (size_t i = 0, prev = size_ - 1; i < size_; prev = i++) {
+      ans += real(coords_[2 * prev]) * real(coords_[2 * i + 1]) -
+             real(coords_[2 * i]) * real(coords_[2 * prev + 1]);
+    }
+    return std::abs(ans / 2);
+  }
+
+  // то же правило, что у Polygon::containsPoint
+  bool containsPoint(const BasicPoint<T>& point) const {
+    bool result = false;
+
+    for (size_t i = 0, prev = size_ - 1; i < size_; prev = i++) {
+      BasicPoint<T> cnt = (*this)[prev];
+      BasicPoint<T> next = (*this)[i];
+      double orientation = orient2d(cnt, next, point);
+
+      if (orientation == 0 && std::min(cnt.x, next.x) <= point.x &&
+          point.x <= std::max(cnt.x, next.x) &&
+          std::min(cnt.y, next.y) <= point.y &&
+          point.y <= std::max(cnt.y, next.y)) {
+        return true;
+      }
+
+      if ((cnt.y < point.y && next.y >= point.y && orientation < 0) ||
+          (next.y < point.y && cnt.y >= point.y && orientation > 0)) {
+        result = !result;
+      }
+    }
+
+    return result;
+  }
+
+  std::vector<BasicPoint<T>> getVertices() const {
+    std::vector<BasicPoint<T>> ans;
+    ans.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+      ans.push_back((*this)[i]);
+    }
+    return ans;
+  }
+};
+
+namespace detail {
+// bbox в координатах файла, для целых округлён наружу
+template <typename T>
+void store_bbox(const BasicShape<T>& shape, T* bbox) {
+  auto box = shape.boundingBox();
+  if constexpr (std::is_integral_v<T>) {
+    bbox[0] = static_cast<T>(std::floor(box.min_x));
+    bbox[1] = static_cast<T>(std::floor(box.min_y));
+    bbox[2] = static_cast<T>(std::ceil(box.max_x));
+    bbox[3] = static_cast<T>(std::ceil(box.max_y));
+  } else {
+    bbox[0] = box.min_x;
+    bbox[1] = box.min_y;
+    bbox[2] = box.max_x;
+    bbox[3] = box.max_y;
+  }
+}
+
+template <typename T>
+ShapeRecord<T> encode_shape(const BasicShape<T>& shape,
+                            std::vector<T>& coords) {
+  using traits = scalar_traits<T>;
+
+  ShapeRecord<T> record{};
+  record.offset = coords.size();
+
+  if (auto* circle = dynamic_cast<const BasicCircle<T>*>(&shape)) {
+    T r = traits::from_real(circle->radius());
+    BasicPoint<T> center = circle->center();
+    record.type = ShapeType::Circle;
+    coords.insert(coords.end(), {center.x, center.y, r});
+  } else if (auto* ellipse = dynamic_cast<const BasicEllipse<T>*>(&shape)) {
+    auto [F1, F2] = ellipse->focuses();
+    record.type = ShapeType::Ellipse;
+    coords.insert(coords.end(),
+                  {F1.x, F1.y, F2.x, F2.y,
+                   traits::from_real(2 * ellipse->semiMajorAxis())});
+  } else if (auto* polygon = dynamic_cast<const BasicPolygon<T>*>(&shape)) {
+    record.type = dynamic_cast<const BasicSquare<T>*>(&shape) != nullptr
+                      ? ShapeType::Square
+                  : dynamic_cast<const BasicRectangle<T>*>(&shape) != nullptr
+                      ? ShapeType::Rectangle
+                  : dynamic_cast<const BasicTriangle<T>*>(&shape) != nullptr
+                      ? ShapeType::Triangle
+                      : ShapeType::Polygon;
+
+    for (const auto& vertex : polygon->getVertices()) {
+      coords.push_back(vertex.x);
+      coords.push_back(vertex.y);
+    }
+  } else {
+    throw std::invalid_argument("write_shapes: unknown shape type");
+  }
+
+  store_bbox(shape, record.bbox);
+
+  record.count = static_cast<uint32_t>(coords.size() - record.offset);
+  return record;
+}
+}  // namespace detail
+
+template <typename T>
+void write_shapes(const std::string& path,
+                  const std::vector<const BasicShape<T>*>& shapes) {
+  std::vector<ShapeRecord<T>> records;
+  std::vector<T> coords;
+  records.reserve(shapes.size());
+  for (const auto* shape : shapes) {
+    records.push_back(detail::encode_shape(*shape, coords));
+  }
+
+  ShapeFileHeader header{};
+  std::memcpy(header.magic, kShapeFileMagic, sizeof(header.magic));
+  header.version = kShapeFileVersion;
+  header.scalar = shape_file_scalar<T>();
+  header.count = records.size();
+  header.records_offset = sizeof(ShapeFileHeader);
+  header.coords_offset =
+      header.records_offset + records.size() * sizeof(ShapeRecord<T>);
+  header.coords_count = coords.size();
+
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  output.write(reinterpret_cast<const char*>(records.data()),
+               records.size() * sizeof(ShapeRecord<T>));
+  output.write(reinterpret_cast<const char*>(coords.data()),
+               coords.size() * sizeof(T));
+  if (!output) {
+    throw std::runtime_error("write_shapes: cannot write " + path);
+  }
+}
+
+// Файл фигур, отображённый в память только для чтения. Загрузка - это
+// проверка заголовка, записи и координаты читаются прямо из страниц файла.
+template <typename T>
+class MappedShapes {
+ private:
+  void* data_ = nullptr;
+  size_t length_ = 0;
+  const ShapeRecord<T>* records_ = nullptr;
+  const T* coords_ = nullptr;
+  size_t count_ = 0;
+
+  void unmap() {
+    if (data_ != nullptr) {
+      ::munmap(data_, length_);
+      data_ = nullptr;
+    }
+  }
+
+  // Сколько координат читают circle, ellipse и polygon для этого типа.
+  static bool valid_count(ShapeType type, uint32_t count) {
+    switch (type) {
+      case ShapeType::Circle:
+        return count == 3;
+      case ShapeType::Ellipse:
+        return count == 5;
+      case ShapeType::Triangle:
+        return count == 6;
+      case ShapeType::Rectangle:
+      case ShapeType::Square:
+        return count == 8;
+      case ShapeType::Polygon:
+        return count >= 6 && count % 2 == 0;
+    }
+    return false;
+  }
+
+  void fail(const std::string& path, const std::string& reason) {
+    unmap();
+    throw std::runtime_error("MappedShapes: " + path + ": " + reason);
+  }
+
+ public:
+  explicit MappedShapes(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("MappedShapes: cannot open " + path);
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("MappedShapes: cannot stat " + path);
+    }
+    length_ = static_cast<size_t>(info.st_size);
+    if (length_ < sizeof(ShapeFileHeader)) {
+      ::close(fd);
+      throw std::runtime_error("MappedShapes: " + path + ": too short");
+    }
+    data_ = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      throw std::runtime_error("MappedShapes: cannot map " + path);
+    }
+
+    const auto* bytes = static_cast<const char*>(data_);
+    const auto* header = reinterpret_cast<const ShapeFileHeader*>(bytes);
+    if (std::memcmp(header->magic, kShapeFileMagic, 4) != 0) {
+      fail(path, "bad magic");
+    }
+    if (header->version != kShapeFileVersion) {
+      fail(path, "unsupported version " + std::to_string(header->version));
+    }
+    if (header->scalar != shape_file_scalar<T>()) {
+      fail(path, "coordinate type mismatch");
+    }
+    // Файл недоверенный: размеры сравниваются с остатком файла делением,
+    // а не суммой, которая может переполниться.
+    if (header->records_offset > length_ ||
+        header->count > (length_ - header->records_offset) /
+                            sizeof(ShapeRecord<T>) ||
+        header->coords_offset > length_ ||
+        header->coords_count > (length_ - header->coords_offset) / sizeof(T) ||
+        header->records_offset + header->count * sizeof(ShapeRecord<T>) >
+            header->coords_offset) {
+      fail(path, "truncated");
+    }
+    if (header->records_offset % alignof(ShapeRecord<T>) != 0 ||
+        header->coords_offset % alignof(T) != 0) {
+      fail(path, "misaligned");
+    }
+
+    count_ = header->count;
+    records_ = reinterpret_cast<const ShapeRecord<T>*>(
+        bytes + header->records_offset);
+    coords_ = reinterpret_cast<const T*>(bytes + header->coords_offset);
+
+    for (size_t i = 0; i < count_; ++i) {
+      const ShapeRecord<T>& record = records_[i];
+      if (!valid_count(record.type, record.count)) {
+        fail(path, "record " + std::to_string(i) + ": bad type or size");
+      }
+      if (record.offset > header->coords_count ||
+          record.count > header->coords_count - record.offset) {
+        fail(path, "record " + std::to_string(i) + " out of range");
+      }
+    }
+  }
+
+  MappedShapes(const MappedShapes&) = delete;
+
+  MappedShapes& operator=(const MappedShapes&) = delete;
+
+  MappedShapes(MappedShapes&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        length_(other.length_),
+        records_(other.records_),
+        coords_(other.coords_),
+        count_(std::exchange(other.count_, 0)) {}
+
+  ~MappedShapes() {
+    unmap();
+  }
+
+  size_t size() const {
+    return count_;
+  }
+
+  ShapeType type(size_t i) const {
+    return records_[i].type;
+  }
+
+  const T* bbox(size_t i) const {
+    return records_[i].bbox;
+  }
+
+  bool isPolygon(size_t i) const {
+    return type(i) != ShapeType::Circle && type(i) != ShapeType::Ellipse;
+  }
+
+  PolygonView<T> polygon(size_t i) const {
+    return PolygonView<T>(coords_ + records_[i].offset, records_[i].count / 2);
+  }
+
+  BasicCircle<T> circle(size_t i) const {
+    const T* c = coords_ + records_[i].offset;
+    return BasicCircle<T>(BasicPoint<T>(c[0], c[1]), c[2]);
+  }
+
+  BasicEllipse<T> ellipse(size_t i) const {
+    const T* c = coords_ + records_[i].offset;
+    return BasicEllipse<T>(BasicPoint<T>(c[0], c[1]),
+                           BasicPoint<T>(c[2], c[3]), c[4]);
+  }
+
+  bool containsPoint(size_t i, const BasicPoint<T>& point) const {
+    const T* box = bbox(i);
+    if (point.x < box[0] || point.y < box[1] || point.x > box[2] ||
+        point.y > box[3]) {
+      return false;
+    }
+    switch (type(i)) {
+      case ShapeType::Circle:
+        return circle(i).containsPoint(point);
+      case ShapeType::Ellipse:
+        return ellipse(i).containsPoint(point);
+      default:
+        return polygon(i).containsPoint(point);
+    }
+  }
+
+  // Восстанавливает фигуру исходного типа (с выделением памяти).
+  std::unique_ptr<BasicShape<T>> shape(size_t i) const {
+    switch (type(i)) {
+      case ShapeType::Circle:
+        return std::make_unique<BasicCircle<T>>(circle(i));
+      case ShapeType::Ellipse:
+        return std::make_unique<BasicEllipse<T>>(ellipse(i));
+      case ShapeType::Triangle: {
+        PolygonView<T> view = polygon(i);
+        return std::make_unique<BasicTriangle<T>>(view[0], view[1], view[2]);
+      }
+      case ShapeType::Square: {
+        PolygonView<T> view = polygon(i);
+        return std::make_unique<BasicSquare<T>>(view[0], view[2]);
+      }
+      case ShapeType::Rectangle: {
+        // Rectangle(P1, P3, k) поворачивает P1 вокруг центра на -2atan(k)
+        PolygonView<T> view = polygon(i);
+        BasicPoint<T> center(
+            (my::BasicVector<T>(view[0]) + my::BasicVector<T>(view[2])) * 0.5);
+        my::BasicVector<T> first(center, view[0]);
+        my::BasicVector<T> second(center, view[1]);
+        double angle = std::atan2(
+            double(first.x_coord) * second.y_coord -
+                double(first.y_coord) * second.x_coord,
+            ScalarProduct(first, second));
+        return std::make_unique<BasicRectangle<T>>(view[0], view[2],
+                                                   std::tan(-angle / 2));
+      }
+      default:
+        return std::make_unique<BasicPolygon<T>>(polygon(i).getVertices());
+    }
+  }
+};
+}  // namespace my
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gauss.h"
+#include "gemm.h"
+#include "matrix.h"
+#include "view.h"
+
+// Матрица с размерами во время выполнения. Данные в куче, строки
+// выровнены на kAlignment байт: шаг строки stride() округлён вверх до
+// целой кэш-линии, хвост строки заполнен нулями. Алгоритмы те же, что у
+// Matrix (gauss.h, gemm.h), поскольку оба типа хранят строки с шагом.
+//
+// Копирование запрещено, чтобы мегабайты не копировались неявно: матрицы
+// только перемещаются, явная копия - clone().
+template <typename Field = Rational>
+class DynamicMatrix {
+ private:
+  static constexpr size_t kAlignment = std::max<size_t>(64, alignof(Field));
+
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t stride_ = 0;
+  Field* data_ = nullptr;
+
+  static size_t padded(size_t cols) {
+    if (kAlignment % sizeof(Field) != 0) {
+      return cols;
+    }
+    size_t per_line = kAlignment / sizeof(Field);
+    return (cols + per_line - 1) / per_line * per_line;
+  }
+
+  void release() {
+    if (data_ == nullptr) {
+      return;
+    }
+    std::destroy_n(data_, rows_ * stride_);
+    ::operator delete(data_, std::align_val_t(kAlignment));
+    data_ = nullptr;
+  }
+
+  void check_same_size(const DynamicMatrix& other, const char* what) const {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+      throw std::invalid_argument(std::string(what) + ": size mismatch");
+    }
+  }
+
+  void check_square(const char* what) const {
+    if (rows_ != cols_) {
+      throw std::invalid_argument(std::string(what) + ": matrix not square");
+    }
+  }
+
+ public:
+  DynamicMatrix() = default;
+
+  DynamicMatrix(size_t rows, size_t cols)
+      : rows_(rows), cols_(cols), stride_(padded(cols)) {
+    if (rows_ * stride_ == 0) {
+      return;
+    }
+    data_ = static_cast<Field*>(::operator new(
+        rows_ * stride_ * sizeof(Field), std::align_val_t(kAlignment)));
+    try {
+      std::uninitialized_fill_n(data_, rows_ * stride_, Field(0));
+    } catch (...) {
+      ::operator delete(data_, std::align_val_t(kAlignment));
+      throw;
+    }
+  }
+
+  DynamicMatrix(std::initializer_list<std::initializer_list<Field>> values)
+      : DynamicMatrix(values.size(),
+                      values.size() == 0 ? 0 : values.begin()->size()) {
+    for (size_t i = 0; i < rows_; ++i) {
+      const auto& row = *(values.begin() + i);
+      if (row.size() != cols_) {
+        throw std::invalid_argument("DynamicMatrix: ragged initializer");
+      }
+      std::copy(row.begin(), row.end(), (*this)[i]);
+    }
+  }
+
+  template <size_t N, size_t M>
+  explicit DynamicMatrix(const Matrix<N, M, Field>& other)
+      : DynamicMatrix(N, M) {
+    for (size_t i = 0; i < N; ++i) {
+      std::copy(other[i].begin(), other[i].end(), (*this)[i]);
+    }
+  }
+
+  // копия содержимого вида, например транспонированного или блока
+  explicit DynamicMatrix(my::MatrixView<const Field> view)
+      : DynamicMatrix(view.rows(), view.cols()) {
+    for (size_t i = 0; i < rows_; ++i) {
+      std::copy(view.row(i).begin(), view.row(i).end(), (*this)[i]);
+    }
+  }
+
+  DynamicMatrix(const DynamicMatrix&) = delete;
+
+  DynamicMatrix(DynamicMatrix&& other) noexcept
+      : rows_(std::exchange(other.rows_, 0)),
+        cols_(std::exchange(other.cols_, 0)),
+        stride_(std::exchange(other.stride_, 0)),
+        data_(std::exchange(other.data_, nullptr)) {}
+
+  DynamicMatrix& operator=(const DynamicMatrix&) = delete;
+
+  DynamicMatrix& operator=(DynamicMatrix&& other) noexcept {
+    if (this != &other) {
+      release();
+      rows_ = std::exchange(other.rows_, 0);
+      cols_ = std::exchange(other.cols_, 0);
+      stride_ = std::exchange(other.stride_, 0);
+      data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+  }
+
+  ~DynamicMatrix() {
+    release();
+  }
+
+  DynamicMatrix clone() const {
+    DynamicMatrix ans(rows_, cols_);
+    std::copy(data_, data_ + rows_ * stride_, ans.data_);
+    return ans;
+  }
+
+  static DynamicMatrix unityMatrix(size_t n) {
+    DynamicMatrix matrix(n, n);
+
+    for (size_t i = 0; i < n; ++i) {
+      matrix[i][i] = Field(1);
+    }
+
+    return matrix;
+  }
+
+  size_t rows() const {
+    return rows_;
+  }
+
+  size_t cols() const {
+    return cols_;
+  }
+
+  // шаг между началами строк в элементах, не меньше cols()
+  size_t stride() const {
+    return stride_;
+  }
+
+  Field* data() {
+    return data_;
+  }
+
+  const Field* data() const {
+    return data_;
+  }
+
+  Field* operator[](size_t i) {
+    return data_ + i * stride_;
+  }
+
+  const Field* operator[](size_t i) const {
+    return data_ + i * stride_;
+  }
+
+  bool operator==(const DynamicMatrix& other) const {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+      return false;
+    }
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        if ((*this)[i][j] != other[i][j]) return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(const DynamicMatrix& other) const {
+    return !(*this == other);
+  }
+
+  DynamicMatrix& operator+=(const DynamicMatrix& other) {
+    check_same_size(other, "DynamicMatrix::operator+=");
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)[i][j] += other[i][j];
+      }
+    }
+
+    return *this;
+  }
+
+  DynamicMatrix& operator-=(const DynamicMatrix& other) {
+    check_same_size(other, "DynamicMatrix::operator-=");
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)[i][j] -= other[i][j];
+      }
+    }
+
+    return *this;
+  }
+
+  DynamicMatrix& operator*=(const Field& elem) {
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        (*this)[i][j] *= elem;
+      }
+    }
+
+    return *this;
+  }
+
+  DynamicMatrix& operator*=(const DynamicMatrix& other);
+
+  std::vector<Field> getRow(size_t i) const {
+    return std::vector<Field>((*this)[i], (*this)[i] + cols_);
+  }
+
+  std::vector<Field> getColumn(size_t i) const {
+    std::vector<Field> ans(rows_);
+
+    for (size_t j = 0; j < rows_; ++j) {
+      ans[j] = (*this)[j][i];
+    }
+
+    return ans;
+  }
+
+  // Виды без копирования: view.h. Действительны, пока жива матрица.
+  my::MatrixView<Field> view() {
+    return my::MatrixView<Field>(data_, rows_, cols_, stride_);
+  }
+
+  my::MatrixView<const Field> view() const {
+    return my::MatrixView<const Field>(data_, rows_, cols_, stride_);
+  }
+
+  my::VectorView<Field> row(size_t i) {
+    return view().row(i);
+  }
+
+  my::VectorView<const Field> row(size_t i) const {
+    return view().row(i);
+  }
+
+  my::VectorView<Field> column(size_t j) {
+    return view().column(j);
+  }
+
+  my::VectorView<const Field> column(size_t j) const {
+    return view().column(j);
+  }
+
+  my::MatrixView<Field> block(size_t row, size_t col, size_t rows,
+                              size_t cols) {
+    return view().block(row, col, rows, cols);
+  }
+
+  my::MatrixView<const Field> block(size_t row, size_t col, size_t rows,
+                                    size_t cols) const {
+    return view().block(row, col, rows, cols);
+  }
+
+  my::MatrixView<const Field> transposedView() const {
+    return view().transposed();
+  }
+
+  Field trace() const {
+    check_square("DynamicMatrix::trace");
+
+    return view().trace();
+  }
+
+  // блоками 32 x 32, чтобы и чтение, и запись шли по кэш-линиям
+  DynamicMatrix transposed() const {
+    const size_t kBlock = 32;
+    DynamicMatrix ans(cols_, rows_);
+
+    for (size_t row = 0; row < rows_; row += kBlock) {
+      for (size_t col = 0; col < cols_; col += kBlock) {
+        for (size_t i = row; i < std::min(rows_, row + kBlock); ++i) {
+          for (size_t j = col; j < std::min(cols_, col + kBlock); ++j) {
+            ans[j][i] = (*this)[i][j];
+          }
+        }
+      }
+    }
+    return ans;
+  }
+
+  // policy - my::seq или my::par (thread_pool.h)
+  template <typename Policy = my::sequenced_policy>
+  Field det(const Policy& policy = my::seq) const {
+    check_square("DynamicMatrix::det");
+
+    DynamicMatrix copy = clone();
+    return my::detail::det(policy, copy.data_, stride_, rows_);
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  size_t rank(const Policy& policy = my::seq) const {
+    DynamicMatrix copy = clone();
+    return my::detail::rank(policy, copy.data_, stride_, rows_, cols_);
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  DynamicMatrix inverted(const Policy& policy = my::seq) const {
+    check_square("DynamicMatrix::inverted");
+
+    DynamicMatrix ans(rows_, cols_);
+    my::detail::inverse(policy, data_, stride_, rows_, ans.data_,
+                        ans.stride_);
+    return ans;
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  DynamicMatrix& invert(const Policy& policy = my::seq) {
+    return *this = inverted(policy);
+  }
+};
+
+template <typename Field>
+std::ostream& operator<<(std::ostream& output,
+                         const DynamicMatrix<Field>& matrix) {
+  for (size_t i = 0; i < matrix.rows(); ++i) {
+    for (size_t j = 0; j < matrix.cols(); ++j) {
+      output << matrix[i][j] << ' ';
+    }
+    output << '\n';
+  }
+
+  return output;
+}
+
+// Первый аргумент-rvalue переиспользует свой буфер под результат.
+template <typename Field>
+DynamicMatrix<Field> operator+(DynamicMatrix<Field>&& first,
+                               const DynamicMatrix<Field>& second) {
+  first += second;
+  return std::move(first);
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator+(const DynamicMatrix<Field>& first,
+                               const DynamicMatrix<Field>& second) {
+  return first.clone() + second;
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator-(DynamicMatrix<Field>&& first,
+                               const DynamicMatrix<Field>& second) {
+  first -= second;
+  return std::move(first);
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator-(const DynamicMatrix<Field>& first,
+                               const DynamicMatrix<Field>& second) {
+  return first.clone() - second;
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator*(DynamicMatrix<Field>&& matrix,
+                               const Field& elem) {
+  matrix *= elem;
+  return std::move(matrix);
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator*(const DynamicMatrix<Field>& matrix,
+                               const Field& elem) {
+  return matrix.clone() * elem;
+}
+
+template <typename Field>
+DynamicMatrix<Field> operator*(const Field& elem,
+                               const DynamicMatrix<Field>& matrix) {
+  return matrix * elem;
+}
+
+namespace my {
+// Произведение с заданной политикой: my::multiply(my::par, a, b).
+template <typename Policy, typename Field>
+DynamicMatrix<Field> multiply(const Policy& policy,
+                              const DynamicMatrix<Field>& first,
+                              const DynamicMatrix<Field>& second) {
+  if (first.cols() != second.rows()) {
+    throw std::invalid_argument("DynamicMatrix::operator*: size mismatch");
+  }
+
+  DynamicMatrix<Field> ans(first.rows(), second.cols());
+  if (ans.rows() != 0 && ans.cols() != 0) {
+    gemm(policy, first.rows(), first.cols(), second.cols(), first.data(),
+         first.stride(), second.data(), second.stride(), ans.data(),
+         ans.stride());
+  }
+  return ans;
+}
+
+// Произведение видов, например a.transposedView() на b.block(...):
+// операнды не копируются.
+template <typename Policy, typename First, typename Second>
+  requires std::same_as<std::remove_const_t<First>,
+                        std::remove_const_t<Second>>
+DynamicMatrix<std::remove_const_t<First>> multiply(
+    const Policy& policy, MatrixView<First> first,
+    MatrixView<Second> second) {
+  if (first.cols() != second.rows()) {
+    throw std::invalid_argument("my::multiply: size mismatch");
+  }
+
+  DynamicMatrix<std::remove_const_t<First>> ans(first.rows(), second.cols());
+  if (ans.rows() != 0 && ans.cols() != 0) {
+    gemm(policy, first, second, ans.view());
+  }
+  return ans;
+}
+}  // namespace my
+
+template <typename Field>
+DynamicMatrix<Field> operator*(const DynamicMatrix<Field>& first,
+                               const DynamicMatrix<Field>& second) {
+  return my::multiply(my::seq, first, second);
+}
+
+template <typename Field>
+DynamicMatrix<Field>& DynamicMatrix<Field>::operator*=(
+    const DynamicMatrix& other) {
+  return *this = *this * other;
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gauss.h"
+#include "modulus.h"
+#include "thread_pool.h"
+#include "view.h"
+
+// Точный определитель и ранг целочисленных матриц без дробей.
+//
+// bareiss_det и bareiss_rank - исключение Bareiss над любым кольцом с
+// точным делением (long long, __int128, BigInteger): миноры не больше
+// оценки Адамара, произведения перед делением - её квадрата; у встроенных
+// целых они считаются вдвое шире, а непомещающийся минор - это
+// std::overflow_error. Matrix и DynamicMatrix над целыми типами
+// (exact_ring) идут через него же в det и rank.
+//
+// crt_det считает определитель по модулю нескольких простых меньше 2^31
+// и собирает его китайской теоремой об остатках (Гарнер) в Integer:
+// элементы остаются машинными словами, длинная арифметика нужна только
+// на сборку. Число простых берётся из оценки Адамара.
+//
+// Заголовок не тянет matrix.h, поэтому работает рядом с BigInteger и
+// Rational из 3_biginteger_rational; матрицы передаются видами.
+namespace my {
+namespace detail {
+// det mod p для n x n целых; p < 2^31 простое, чтобы (p - f) * x + y
+// помещалось в uint64_t
+template <typename T>
+uint64_t det_mod(MatrixView<const T> matrix, uint64_t p) {
+  size_t n = matrix.rows();
+  std::vector<uint64_t> data(n * n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      __int128 value = static_cast<__int128>(matrix(i, j)) % p;
+      data[i * n + j] = static_cast<uint64_t>(value < 0 ? value + p : value);
+    }
+  }
+
+  uint64_t ans = 1;
+  for (size_t col = 0; col < n; ++col) {
+    size_t pivot = col;
+    while (pivot < n && data[pivot * n + col] == 0) {
+      ++pivot;
+    }
+    if (pivot == n) {
+      return 0;
+    }
+    uint64_t* top = data.data() + col * n;
+    if (pivot != col) {
+      std::swap_ranges(top + col, top + n, data.data() + pivot * n + col);
+      ans = p - ans;
+    }
+
+    ans = ans * top[col] % p;
+    uint64_t inverse = pow_mod(top[col], p - 2, p);
+    for (size_t i = col + 1; i < n; ++i) {
+      uint64_t* current = data.data() + i * n;
+      uint64_t koef = p - current[col] * inverse % p;
+      if (koef == p) {
+        continue;
+      }
+      for (size_t j = col + 1; j < n; ++j) {
+        current[j] = (current[j] + koef * top[j]) % p;
+      }
+    }
+  }
+  return ans % p;
+}
+
+// count наибольших простых меньше 2^31, по убыванию
+inline std::vector<uint64_t> crt_primes(size_t count) {
+  std::vector<uint64_t> primes;
+  for (uint64_t p = (uint64_t(1) << 31) - 1; primes.size() < count; p -= 2) {
+    if (is_prime_number(p)) {
+      primes.push_back(p);
+    }
+  }
+  return primes;
+}
+
+template <typename Ring, typename T>
+std::vector<Ring> dense_copy(MatrixView<T> matrix) {
+  std::vector<Ring> data;
+  data.reserve(matrix.rows() * matrix.cols());
+  for (size_t i = 0; i < matrix.rows(); ++i) {
+    for (const auto& elem : matrix.row(i)) {
+      data.emplace_back(elem);
+    }
+  }
+  return data;
+}
+
+template <typename T>
+concept has_view = requires(const T& matrix) { matrix.view(); };
+}  // namespace detail
+
+template <typename T, typename Policy = sequenced_policy>
+std::remove_const_t<T> bareiss_det(MatrixView<T> matrix,
+                                   const Policy& policy = seq) {
+  using Ring = std::remove_const_t<T>;
+  size_t n = matrix.rows();
+  if (matrix.cols() != n) {
+    throw std::invalid_argument("bareiss_det: matrix not square");
+  }
+  if (n == 0) {
+    return Ring(1);
+  }
+
+  auto data = detail::dense_copy<Ring>(matrix);
+  bool inversions = false;
+  if (detail::bareiss(policy, data.data(), n, n, n, inversions) < n) {
+    return Ring(0);
+  }
+  return inversions ? Ring(0) - data.back() : data.back();
+}
+
+template <typename T, typename Policy = sequenced_policy>
+size_t bareiss_rank(MatrixView<T> matrix, const Policy& policy = seq) {
+  using Ring = std::remove_const_t<T>;
+  auto data = detail::dense_copy<Ring>(matrix);
+  bool inversions = false;
+  return detail::bareiss(policy, data.data(), matrix.cols(), matrix.rows(),
+                         matrix.cols(), inversions);
+}
+
+// Integer - любой тип с конструктором от int64_t, +, * и -=; в нём
+// должен помещаться определитель, произведение простых - не обязательно.
+// Остатки по разным простым считаются параллельно.
+template <typename Integer, typename T, typename Policy = sequenced_policy>
+  requires std::integral<std::remove_const_t<T>>
+Integer crt_det(MatrixView<T> matrix, const Policy& policy = seq) {
+  size_t n = matrix.rows();
+  if (matrix.cols() != n) {
+    throw std::invalid_argument("crt_det: matrix not square");
+  }
+
+  // |det| <= prod ||row||, а простые больше 2^30: модуль должен быть
+  // больше 2 |det|, чтобы восстановить знак
+  long double bits = 0;
+  for (size_t i = 0; i < n; ++i) {
+    long double norm = 0;
+    for (const auto& elem : matrix.row(i)) {
+      norm += static_cast<long double>(elem) * elem;
+    }
+    if (norm == 0) {
+      return Integer(0);
+    }
+    bits += std::log2(norm) / 2;
+  }
+  size_t count = static_cast<size_t>(bits / 30) + 2;
+
+  std::vector<uint64_t> primes = detail::crt_primes(count);
+  std::vector<uint64_t> residues(count);
+  MatrixView<const std::remove_const_t<T>> source = matrix;
+  policy.parallel_for(count, 1, [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; ++k) {
+      residues[k] = detail::det_mod(source, primes[k]);
+    }
+  });
+
+  // Гарнер: det = x[0] + x[1] p[0] + x[2] p[0] p[1] + ..., 0 <= x[k] < p[k]
+  std::vector<uint64_t> digits(count);
+  for (size_t k = 0; k < count; ++k) {
+    uint64_t p = primes[k];
+    uint64_t value = residues[k];
+    for (size_t j = 0; j < k; ++j) {
+      uint64_t inverse = detail::pow_mod(primes[j] % p, p - 2, p);
+      value = (value + p - digits[j] % p) % p * inverse % p;
+    }
+    digits[k] = value;
+  }
+
+  // Модуль M = p[0] p[1] ... в Integer не строится: он много больше det.
+  // det < 0, если x > (M - 1) / 2; сравниваются цифры со старшей, а
+  // (M - 1) / 2 делится на 2 по цифрам M - 1, то есть p[k] - 1.
+  std::vector<uint64_t> half(count);
+  uint64_t carry = 0;
+  for (size_t k = count; k-- > 0;) {
+    uint64_t value = carry * primes[k] + primes[k] - 1;
+    half[k] = value / 2;
+    carry = value % 2;
+  }
+  bool negative = std::lexicographical_compare(
+      half.rbegin(), half.rend(), digits.rbegin(), digits.rend());
+  if (negative) {
+    // |det| = M - x = (M - 1 - x) + 1
+    uint64_t add = 1;
+    for (size_t k = 0; k < count; ++k) {
+      digits[k] = primes[k] - 1 - digits[k] + add;
+      add = digits[k] == primes[k] ? 1 : 0;
+      if (add) {
+        digits[k] = 0;
+      }
+    }
+  }
+
+  // схема Горнера со старшей цифры: все частичные суммы не больше |det|
+  Integer ans(static_cast<int64_t>(digits[count - 1]));
+  for (size_t k = count - 1; k-- > 0;) {
+    ans = ans * Integer(static_cast<int64_t>(primes[k])) +
+          Integer(static_cast<int64_t>(digits[k]));
+  }
+  if (negative) {
+    Integer abs = ans;
+    ans = Integer(0);
+    ans -= abs;
+  }
+  return ans;
+}
+
+template <typename MatrixType, typename Policy = sequenced_policy>
+  requires detail::has_view<MatrixType>
+auto bareiss_det(const MatrixType& matrix, const Policy& policy = seq) {
+  return bareiss_det(matrix.view(), policy);
+}
+
+template <typename MatrixType, typename Policy = sequenced_policy>
+  requires detail::has_view<MatrixType>
+size_t bareiss_rank(const MatrixType& matrix, const Policy& policy = seq) {
+  return bareiss_rank(matrix.view(), policy);
+}
+
+template <typename Integer, typename MatrixType,
+          typename Policy = sequenced_policy>
+  requires detail::has_view<MatrixType>
+Integer crt_det(const MatrixType& matrix, const Policy& policy = seq) {
+  return crt_det<Integer>(matrix.view(), policy);
+}
+}  // namespace my
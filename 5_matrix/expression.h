@@ -0,0 +1,218 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template <size_t N, size_t M, typename Field>
+class Matrix;
+
+// Ленивые поэлементные выражения над Matrix. A + B - C * k строит дерево
+// из лёгких узлов, а не три временные матрицы; значение считается одним
+// проходом, когда выражение присваивается матрице. Поэлементный узел
+// читает только свою клетку, поэтому A = A + B * k безопасно делать на
+// месте. Произведение матриц не поэлементное и по-прежнему сразу
+// считается в Matrix.
+//
+// Листья-lvalue хранятся по ссылке, временные матрицы - по значению,
+// чтобы выражение с A * B не ссылалось на уничтоженный результат.
+//
+// Методы Matrix у выражения нет: (A + B).eval().det().
+namespace my::detail {
+struct expression_tag {};
+
+template <typename Derived>
+struct expression_base : expression_tag {
+  auto eval() const {
+    return Matrix<Derived::rows, Derived::cols, typename Derived::field_type>(
+        static_cast<const Derived&>(*this));
+  }
+};
+
+template <typename T>
+concept matrix_expression =
+    std::derived_from<std::remove_cvref_t<T>, expression_tag>;
+
+template <typename T>
+struct operand_traits {};
+
+template <size_t N, size_t M, typename Field>
+struct operand_traits<Matrix<N, M, Field>> {
+  static constexpr size_t rows = N;
+  static constexpr size_t cols = M;
+  using field_type = Field;
+};
+
+template <matrix_expression T>
+struct operand_traits<T> {
+  static constexpr size_t rows = T::rows;
+  static constexpr size_t cols = T::cols;
+  using field_type = typename T::field_type;
+};
+
+template <typename T>
+concept matrix_operand = requires {
+  typename operand_traits<std::remove_cvref_t<T>>::field_type;
+};
+
+template <typename T>
+using field_of = typename operand_traits<std::remove_cvref_t<T>>::field_type;
+
+template <typename First, typename Second>
+concept same_shape =
+    matrix_operand<First> && matrix_operand<Second> &&
+    std::same_as<field_of<First>, field_of<Second>> &&
+    operand_traits<std::remove_cvref_t<First>>::rows ==
+        operand_traits<std::remove_cvref_t<Second>>::rows &&
+    operand_traits<std::remove_cvref_t<First>>::cols ==
+        operand_traits<std::remove_cvref_t<Second>>::cols;
+
+template <typename T>
+using stored_operand =
+    std::conditional_t<std::is_lvalue_reference_v<T> &&
+                           !matrix_expression<T>,
+                       const std::remove_cvref_t<T>&, std::remove_cvref_t<T>>;
+
+template <size_t N, size_t M, typename Field>
+const Field& element(const Matrix<N, M, Field>& matrix, size_t i, size_t j) {
+  return matrix[i][j];
+}
+
+template <matrix_expression Expr>
+auto element(const Expr& expr, size_t i, size_t j) {
+  return expr.at(i, j);
+}
+
+struct plus {
+  template <typename Field>
+  static void apply(Field& acc, const Field& other) {
+    acc += other;
+  }
+};
+
+struct minus {
+  template <typename Field>
+  static void apply(Field& acc, const Field& other) {
+    acc -= other;
+  }
+};
+
+template <typename Op, typename First, typename Second>
+class BinaryExpression
+    : public expression_base<BinaryExpression<Op, First, Second>> {
+ private:
+  First first_;
+  Second second_;
+
+ public:
+  using field_type = field_of<First>;
+  static constexpr size_t rows =
+      operand_traits<std::remove_cvref_t<First>>::rows;
+  static constexpr size_t cols =
+      operand_traits<std::remove_cvref_t<First>>::cols;
+
+  template <typename Lhs, typename Rhs>
+  BinaryExpression(Lhs&& first, Rhs&& second)
+      : first_(std::forward<Lhs>(first)), second_(std::forward<Rhs>(second)) {}
+
+  field_type at(size_t i, size_t j) const {
+    field_type ans = element(first_, i, j);
+    Op::apply(ans, element(second_, i, j));
+    return ans;
+  }
+};
+
+template <typename Operand>
+class ScaledExpression : public expression_base<ScaledExpression<Operand>> {
+ private:
+  Operand operand_;
+  field_of<Operand> scalar_;
+
+ public:
+  using field_type = field_of<Operand>;
+  static constexpr size_t rows =
+      operand_traits<std::remove_cvref_t<Operand>>::rows;
+  static constexpr size_t cols =
+      operand_traits<std::remove_cvref_t<Operand>>::cols;
+
+  template <typename Arg>
+  ScaledExpression(Arg&& operand, const field_type& scalar)
+      : operand_(std::forward<Arg>(operand)), scalar_(scalar) {}
+
+  field_type at(size_t i, size_t j) const {
+    field_type ans = element(operand_, i, j);
+    ans *= scalar_;
+    return ans;
+  }
+};
+
+// Matrix для выражения и ссылка на саму матрицу для листа: нужно там,
+// где выражение всё же приходится вычислить (произведение).
+template <size_t N, size_t M, typename Field>
+const Matrix<N, M, Field>& evaluate(const Matrix<N, M, Field>& matrix) {
+  return matrix;
+}
+
+template <matrix_expression Expr>
+auto evaluate(const Expr& expr) {
+  return expr.eval();
+}
+}  // namespace my::detail
+
+template <typename First, typename Second>
+  requires my::detail::same_shape<First, Second>
+auto operator+(First&& first, Second&& second) {
+  namespace detail = my::detail;
+  return detail::BinaryExpression<detail::plus,
+                                  detail::stored_operand<First>,
+                                  detail::stored_operand<Second>>(
+      std::forward<First>(first), std::forward<Second>(second));
+}
+
+template <typename First, typename Second>
+  requires my::detail::same_shape<First, Second>
+auto operator-(First&& first, Second&& second) {
+  namespace detail = my::detail;
+  return detail::BinaryExpression<detail::minus,
+                                  detail::stored_operand<First>,
+                                  detail::stored_operand<Second>>(
+      std::forward<First>(first), std::forward<Second>(second));
+}
+
+template <my::detail::matrix_operand Operand>
+auto operator*(Operand&& operand, const my::detail::field_of<Operand>& elem) {
+  return my::detail::ScaledExpression<my::detail::stored_operand<Operand>>(
+      std::forward<Operand>(operand), elem);
+}
+
+template <my::detail::matrix_operand Operand>
+auto operator*(const my::detail::field_of<Operand>& elem, Operand&& operand) {
+  return std::forward<Operand>(operand) * elem;
+}
+
+// Сравнение без вычисления выражения в матрицу; Matrix == Matrix -
+// по-прежнему член класса.
+template <typename First, typename Second>
+  requires my::detail::same_shape<First, Second> &&
+           (my::detail::matrix_expression<First> ||
+            my::detail::matrix_expression<Second>)
+bool operator==(const First& first, const Second& second) {
+  for (size_t i = 0; i < my::detail::operand_traits<First>::rows; ++i) {
+    for (size_t j = 0; j < my::detail::operand_traits<First>::cols; ++j) {
+      if (my::detail::element(first, i, j) !=
+          my::detail::element(second, i, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename First, typename Second>
+  requires my::detail::same_shape<First, Second> &&
+           (my::detail::matrix_expression<First> ||
+            my::detail::matrix_expression<Second>)
+bool operator!=(const First& first, const Second& second) {
+  return !(first == second);
+}
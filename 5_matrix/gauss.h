@@ -0,0 +1,424 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gemm.h"
+
+// Метод Гаусса над строками, лежащими в памяти с шагом stride элементов.
+// Общий для Matrix и DynamicMatrix: оба хранят данные построчно.
+namespace my {
+// Кольца, где / - деление нацело (целые, BigInteger): для них det и
+// rank идут через Bareiss, а не через деление в step_view.
+// Специализируется для своих типов.
+template <typename Ring>
+struct exact_ring
+    : std::bool_constant<std::numeric_limits<Ring>::is_integer> {};
+}  // namespace my
+
+namespace my::detail {
+// Сколько строк брать в один параллельный кусок, чтобы в нём было порядка
+// kMinWork операций: мелкие шаги исключения остаются одним куском.
+inline size_t row_grain(size_t width) {
+  const size_t kMinWork = 1 << 14;
+  return std::max<size_t>(1, kMinWork / std::max<size_t>(1, width));
+}
+
+// Прямой ход: приводит rows x cols к ступенчатому виду, опорные элементы
+// ищутся только в первых pivot_cols столбцах. Возвращает чётность числа
+// перестановок строк. Строки под опорной вычитаются параллельно.
+template <typename Policy, typename Field>
+bool step_view(const Policy& policy, Field* data, size_t stride, size_t rows,
+               size_t cols, size_t pivot_cols) {
+  bool inversions = false;
+  size_t row = 0;
+  size_t collum = 0;
+
+  const Field zero(0);
+
+  while (row < rows && collum < pivot_cols) {
+    bool find_non_zero_elem = false;
+
+    for (size_t i = row; i < rows; ++i) {
+      if (data[i * stride + collum] != zero) {
+        if (i != row) {
+          inversions = !inversions;
+
+          for (size_t j = collum; j < cols; ++j) {
+            std::swap(data[i * stride + j], data[row * stride + j]);
+          }
+        }
+
+        find_non_zero_elem = true;
+        break;
+      }
+    }
+
+    if (!find_non_zero_elem) {
+      ++collum;
+      continue;
+    }
+
+    Field* pivot = data + row * stride;
+    policy.parallel_for(
+        rows - row - 1, row_grain(cols - collum),
+        [&](size_t begin, size_t end) {
+          for (size_t i = row + 1 + begin; i < row + 1 + end; ++i) {
+            Field* current = data + i * stride;
+            Field koef = current[collum] / pivot[collum];
+            for (size_t j = collum; j < cols; ++j) {
+              current[j] -= koef * pivot[j];
+            }
+          }
+        });
+    ++row;
+    ++collum;
+  }
+
+  return inversions;
+}
+
+// Упорядоченные поля (double, Rational) выбирают главным наибольший по
+// модулю элемент столбца, остальные (Residue) - первый ненулевой.
+template <typename Field>
+concept ordered_field = requires(const Field& elem) {
+  { elem < elem } -> std::convertible_to<bool>;
+};
+
+template <typename Field>
+size_t lu_pivot(const Field* data, size_t stride, size_t n, size_t k) {
+  const Field zero(0);
+  size_t ans = n;
+  if constexpr (ordered_field<Field>) {
+    Field best = zero;
+    for (size_t i = k; i < n; ++i) {
+      const Field& elem = data[i * stride + k];
+      Field magnitude = elem < zero ? zero - elem : elem;
+      if (best < magnitude) {
+        best = magnitude;
+        ans = i;
+      }
+    }
+    return ans != n && best != zero ? ans : n;
+  } else {
+    for (size_t i = k; i < n; ++i) {
+      if (data[i * stride + k] != zero) {
+        return i;
+      }
+    }
+    return n;
+  }
+}
+
+// PA = LU на месте с выбором главного элемента по столбцу: под диагональю
+// L (единицы на диагонали не хранятся), на диагонали и выше - U; perm[i] -
+// номер исходной строки, попавшей на место i. Возвращает чётность числа
+// перестановок строк. Нулевой столбец пропускается, и U[k][k] остаётся 0.
+//
+// Правосторонний блочный вариант: панель из kBlock столбцов раскладывается
+// по столбцам, затем решается блок U12 = L11^-1 A12, и весь хвост
+// обновляется одним A22 -= L21 U12 через gemm_subtract. Почти вся работа
+// приходится на это умножение, а не на построчные вычитания. Параллельны
+// строки панели, столбцы U12 и плитки умножения.
+template <typename Policy, typename Field>
+bool lu_factor(const Policy& policy, Field* data, size_t stride, size_t n,
+               size_t* perm) {
+  const size_t kBlock = 64;
+  bool inversions = false;
+  for (size_t i = 0; i < n; ++i) {
+    perm[i] = i;
+  }
+
+  for (size_t begin = 0; begin < n; begin += kBlock) {
+    size_t end = std::min(n, begin + kBlock);
+
+    for (size_t k = begin; k < end; ++k) {
+      size_t pivot = lu_pivot(data, stride, n, k);
+      if (pivot == n) {
+        continue;
+      }
+      Field* row = data + k * stride;
+      if (pivot != k) {
+        inversions = !inversions;
+        std::swap(perm[k], perm[pivot]);
+        std::swap_ranges(row, row + n, data + pivot * stride);
+      }
+
+      Field inverse = Field(1) / row[k];
+      policy.parallel_for(
+          n - k - 1, row_grain(end - k), [&](size_t first, size_t last) {
+            for (size_t i = k + 1 + first; i < k + 1 + last; ++i) {
+              Field* current = data + i * stride;
+              current[k] *= inverse;
+              for (size_t j = k + 1; j < end; ++j) {
+                current[j] -= current[k] * row[j];
+              }
+            }
+          });
+    }
+
+    if (end == n) {
+      break;
+    }
+
+    // U12: прямая подстановка с единичной L11, столбцы независимы
+    policy.parallel_for(n - end, kBlock, [&](size_t first, size_t last) {
+      for (size_t k = begin; k < end; ++k) {
+        const Field* row = data + k * stride + end;
+        for (size_t i = k + 1; i < end; ++i) {
+          Field* current = data + i * stride;
+          const Field& koef = current[k];
+          current += end;
+          for (size_t j = first; j < last; ++j) {
+            current[j] -= koef * row[j];
+          }
+        }
+      }
+    });
+
+    gemm_subtract(policy, n - end, end - begin, n - end,
+                  data + end * stride + begin, stride,
+                  data + begin * stride + end, stride,
+                  data + end * stride + end, stride);
+  }
+
+  return inversions;
+}
+
+// Решает LU X = P B для m столбцов правой части: строки X - строки B в
+// порядке perm, затем прямой ход по L и обратный по U. Подстановка идёт
+// блоками по kBlock строк: вклад уже найденных строк вычитается одним
+// gemm_subtract, внутри блока - построчно. Столбцы правой части
+// независимы, и параллельно решаются их полосы по kBlock.
+template <typename Policy, typename Field>
+void lu_solve(const Policy& policy, const Field* lu, size_t stride, size_t n,
+              const size_t* perm, const Field* b, size_t b_stride, Field* x,
+              size_t x_stride, size_t m) {
+  const size_t kBlock = 64;
+  policy.parallel_for(m, kBlock, [&](size_t first, size_t last) {
+    size_t width = last - first;
+    Field* y = x + first;
+    for (size_t i = 0; i < n; ++i) {
+      const Field* src = b + perm[i] * b_stride + first;
+      std::copy(src, src + width, y + i * x_stride);
+    }
+
+    auto subtract_row = [&](size_t i, size_t k) {
+      const Field& koef = lu[i * stride + k];
+      Field* current = y + i * x_stride;
+      const Field* row = y + k * x_stride;
+      for (size_t j = 0; j < width; ++j) {
+        current[j] -= koef * row[j];
+      }
+    };
+
+    for (size_t begin = 0; begin < n; begin += kBlock) {
+      size_t end = std::min(n, begin + kBlock);
+      gemm_subtract(end - begin, begin, width, lu + begin * stride, stride, y,
+                    x_stride, y + begin * x_stride, x_stride);
+      for (size_t i = begin; i < end; ++i) {
+        for (size_t k = begin; k < i; ++k) {
+          subtract_row(i, k);
+        }
+      }
+    }
+
+    for (size_t end = n; end > 0;) {
+      size_t begin = end > kBlock ? end - kBlock : 0;
+      gemm_subtract(end - begin, n - end, width, lu + begin * stride + end,
+                    stride, y + end * x_stride, x_stride,
+                    y + begin * x_stride, x_stride);
+      for (size_t i = end; i-- > begin;) {
+        for (size_t k = i + 1; k < end; ++k) {
+          subtract_row(i, k);
+        }
+        Field inverse = Field(1) / lu[i * stride + i];
+        Field* current = y + i * x_stride;
+        for (size_t j = 0; j < width; ++j) {
+          current[j] *= inverse;
+        }
+      }
+      end = begin;
+    }
+  });
+}
+
+// Определитель по уже разложенной матрице.
+template <typename Field>
+Field lu_det(const Field* lu, size_t stride, size_t n, bool inversions) {
+  Field ans(1);
+  for (size_t i = 0; i < n; ++i) {
+    ans *= lu[i * stride + i];
+  }
+  return Field(inversions ? -1 : 1) * ans;
+}
+
+// Шаг Bareiss: value = (pivot * value - left * top) / previous. Частное
+// - минор исходной матрицы, но произведения до деления порядка его
+// квадрата, поэтому у встроенных целых они считаются в __int128 (у
+// самого __int128 - с проверкой переполнения). false, если минор или
+// произведения не помещаются в Ring.
+template <typename Ring>
+bool bareiss_update(const Ring& pivot, const Ring& left, const Ring& top,
+                    const Ring& previous, Ring& value) {
+  using limits = std::numeric_limits<Ring>;
+  if constexpr (limits::is_integer && limits::is_signed &&
+                limits::digits < 64) {
+    __int128 wide = (static_cast<__int128>(pivot) * value -
+                     static_cast<__int128>(left) * top) /
+                    previous;
+    if (wide < limits::min() || wide > limits::max()) {
+      return false;
+    }
+    value = static_cast<Ring>(wide);
+  } else if constexpr (std::is_same_v<Ring, __int128>) {
+    Ring first;
+    Ring second;
+    if (__builtin_mul_overflow(pivot, value, &first) ||
+        __builtin_mul_overflow(left, top, &second) ||
+        __builtin_sub_overflow(first, second, &first)) {
+      return false;
+    }
+    value = first / previous;
+  } else {
+    value = (pivot * value - left * top) / previous;
+  }
+  return true;
+}
+
+// Bareiss: исключение без дробей для целочисленных колец. После шага
+// с опорным pivot элементы хвоста - миноры исходной матрицы, поэтому
+// деление на предыдущий опорный элемент точное, а миноры ограничены
+// оценкой Адамара, а не растут экспоненциально. Столбцы без опорного
+// элемента пропускаются, так что это и ранг. Возвращает ранг;
+// inversions - чётность перестановок строк. Если минор не помещается во
+// встроенный целый Ring - std::overflow_error, а не неверный ответ.
+template <typename Policy, typename Ring>
+size_t bareiss(const Policy& policy, Ring* data, size_t stride, size_t rows,
+               size_t cols, bool& inversions) {
+  const Ring zero(0);
+  Ring previous(1);
+  size_t row = 0;
+  inversions = false;
+
+  for (size_t col = 0; col < cols && row < rows; ++col) {
+    size_t pivot = row;
+    while (pivot < rows && data[pivot * stride + col] == zero) {
+      ++pivot;
+    }
+    if (pivot == rows) {
+      continue;
+    }
+    if (pivot != row) {
+      inversions = !inversions;
+      std::swap_ranges(data + row * stride + col, data + row * stride + cols,
+                       data + pivot * stride + col);
+    }
+
+    const Ring* top = data + row * stride;
+    // исключение из потока пула не долетит до вызывающего
+    std::atomic<bool> overflow(false);
+    policy.parallel_for(
+        rows - row - 1, row_grain(cols - col), [&](size_t begin, size_t end) {
+          for (size_t i = row + 1 + begin; i < row + 1 + end; ++i) {
+            Ring* current = data + i * stride;
+            for (size_t j = col + 1; j < cols; ++j) {
+              if (!bareiss_update(top[col], current[col], top[j], previous,
+                                  current[j])) {
+                overflow = true;
+              }
+            }
+            current[col] = zero;
+          }
+        });
+    if (overflow) {
+      throw std::overflow_error("bareiss: integer overflow");
+    }
+    previous = top[col];
+    ++row;
+  }
+  return row;
+}
+
+// Определитель n x n; data портится.
+template <typename Policy, typename Field>
+Field det(const Policy& policy, Field* data, size_t stride, size_t n) {
+  if constexpr (exact_ring<Field>::value) {
+    bool inversions = false;
+    if (n == 0) {
+      return Field(1);
+    }
+    if (bareiss(policy, data, stride, n, n, inversions) < n) {
+      return Field(0);
+    }
+    const Field& last = data[(n - 1) * stride + n - 1];
+    return inversions ? Field(0) - last : last;
+  } else {
+    std::vector<size_t> perm(n);
+    bool inversions = lu_factor(policy, data, stride, n, perm.data());
+    return lu_det(data, stride, n, inversions);
+  }
+}
+
+// Ранг rows x cols; data портится.
+template <typename Policy, typename Field>
+size_t rank(const Policy& policy, Field* data, size_t stride, size_t rows,
+            size_t cols) {
+  if constexpr (exact_ring<Field>::value) {
+    bool inversions = false;
+    return bareiss(policy, data, stride, rows, cols, inversions);
+  } else {
+    step_view(policy, data, stride, rows, cols, cols);
+
+    const Field zero(0);
+    size_t ans = 0;
+    for (size_t i = 0; i < rows; ++i) {
+      bool non_zero_row = false;
+      for (size_t j = i; j < cols; ++j) {
+        if (data[i * stride + j] != zero) {
+          non_zero_row = true;
+          break;
+        }
+      }
+      ans += non_zero_row;
+    }
+    return ans;
+  }
+}
+
+// Обратная к n x n из src в dst: одно разложение и решение для единичной
+// правой части. Копия под разложение живёт в куче; вырожденная матрица -
+// std::domain_error.
+template <typename Policy, typename Field>
+void inverse(const Policy& policy, const Field* src, size_t src_stride,
+             size_t n, Field* dst, size_t dst_stride) {
+  std::vector<Field> lu(n * n);
+  for (size_t i = 0; i < n; ++i) {
+    std::copy(src + i * src_stride, src + i * src_stride + n,
+              lu.begin() + i * n);
+  }
+  std::vector<size_t> perm(n);
+  lu_factor(policy, lu.data(), n, n, perm.data());
+
+  // как LUDecomposition::inverse: нулевой элемент U - вырожденная матрица
+  const Field zero(0);
+  for (size_t i = 0; i < n; ++i) {
+    if (lu[i * n + i] == zero) {
+      throw std::domain_error("inverse: singular matrix");
+    }
+  }
+
+  std::vector<Field> unity(n * n, Field(0));
+  for (size_t i = 0; i < n; ++i) {
+    unity[i * n + i] = Field(1);
+  }
+  lu_solve(policy, lu.data(), n, n, perm.data(), unity.data(), n, dst,
+           dst_stride, n);
+}
+}  // namespace my::detail
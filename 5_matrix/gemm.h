@@ -0,0 +1,420 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Умножение матриц C = A * B в построчном хранении: строки A, B и C идут с
+// шагами lda, ldb и ldc элементов. Внутри у каждой матрицы есть и шаг
+// столбца, так что view.h умножает транспонированные виды без копий.
+//
+// Для полей с gemm_traits<Field>::packed схема как в BLIS: B режется на
+// блоки kBlockDepth x kBlockCols, A - на kBlockRows x kBlockDepth, блоки
+// упаковываются в панели (kRows строк A или kCols столбцов B подряд по
+// глубине), а микроядро считает плитку kRows x kCols в регистрах. Панель
+// B живёт в L2/L3, панель A - в L1, плитка C - в регистрах.
+//
+// Остальные поля умножаются обычным циклом i-k-j без копирования строк.
+namespace my {
+template <typename Field>
+struct gemm_traits {
+  static constexpr bool packed = false;
+};
+
+namespace detail {
+// Плитка kRows x kCols на скалярах; компилятор сам раскладывает её по
+// векторным регистрам, если может.
+template <typename T, size_t Rows, size_t Cols>
+void scalar_kernel(size_t depth, const T* a, const T* b, T* tile) {
+  T acc[Rows][Cols] = {};
+  for (size_t p = 0; p < depth; ++p, a += Rows, b += Cols) {
+    for (size_t i = 0; i < Rows; ++i) {
+      for (size_t j = 0; j < Cols; ++j) {
+        acc[i][j] += a[i] * b[j];
+      }
+    }
+  }
+  for (size_t i = 0; i < Rows; ++i) {
+    std::copy(acc[i], acc[i] + Cols, tile + i * Cols);
+  }
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+// Плитка 6 x 2 вектора: 12 регистров-аккумуляторов из 16. Циклы по строкам
+// разворачиваются прагмой, иначе на -O2 аккумуляторы уходят в память.
+inline void avx2_kernel(size_t depth, const double* a, const double* b,
+                        double* tile) {
+  __m256d acc[6][2];
+#pragma GCC unroll 6
+  for (size_t i = 0; i < 6; ++i) {
+    acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+  }
+  for (size_t p = 0; p < depth; ++p, a += 6, b += 8) {
+    __m256d first = _mm256_loadu_pd(b);
+    __m256d second = _mm256_loadu_pd(b + 4);
+#pragma GCC unroll 6
+    for (size_t i = 0; i < 6; ++i) {
+      __m256d elem = _mm256_broadcast_sd(a + i);
+      acc[i][0] = _mm256_fmadd_pd(elem, first, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_pd(elem, second, acc[i][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (size_t i = 0; i < 6; ++i) {
+    _mm256_storeu_pd(tile + 8 * i, acc[i][0]);
+    _mm256_storeu_pd(tile + 8 * i + 4, acc[i][1]);
+  }
+}
+
+inline void avx2_kernel(size_t depth, const float* a, const float* b,
+                        float* tile) {
+  __m256 acc[6][2];
+#pragma GCC unroll 6
+  for (size_t i = 0; i < 6; ++i) {
+    acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+  }
+  for (size_t p = 0; p < depth; ++p, a += 6, b += 16) {
+    __m256 first = _mm256_loadu_ps(b);
+    __m256 second = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+    for (size_t i = 0; i < 6; ++i) {
+      __m256 elem = _mm256_broadcast_ss(a + i);
+      acc[i][0] = _mm256_fmadd_ps(elem, first, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(elem, second, acc[i][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (size_t i = 0; i < 6; ++i) {
+    _mm256_storeu_ps(tile + 16 * i, acc[i][0]);
+    _mm256_storeu_ps(tile + 16 * i + 8, acc[i][1]);
+  }
+}
+#endif
+
+template <typename T>
+struct float_gemm_traits {
+  static constexpr bool packed = true;
+  using value_type = T;
+
+#if defined(__AVX2__) && defined(__FMA__)
+  static constexpr size_t kRows = 6;
+  static constexpr size_t kCols = 32 / sizeof(T) * 2;
+
+  static void kernel(size_t depth, const T* a, const T* b, T* tile) {
+    avx2_kernel(depth, a, b, tile);
+  }
+#else
+  static constexpr size_t kRows = 4;
+  static constexpr size_t kCols = 8;
+
+  static void kernel(size_t depth, const T* a, const T* b, T* tile) {
+    scalar_kernel<T, kRows, kCols>(depth, a, b, tile);
+  }
+#endif
+
+  static T load(T elem) {
+    return elem;
+  }
+
+  static void store(T& elem, T sum) {
+    elem += sum;
+  }
+
+  static void subtract(T& elem, T sum) {
+    elem -= sum;
+  }
+};
+
+// Вычеты по модулю Mod с полем value в [0, Mod). Произведения меньше
+// (Mod - 1)^2 < 2^64, так что в uint64_t без переполнения помещается
+// kTerms слагаемых подряд; после каждых kTerms сумма берётся по модулю.
+// Для малых модулей kTerms ограничено, чтобы begin + kTerms не
+// переполнялось.
+template <typename Field, uint64_t Mod>
+struct modular_gemm_traits {
+  static_assert(Mod - 1 <= std::numeric_limits<uint32_t>::max());
+
+  static constexpr bool packed = true;
+  using value_type = uint64_t;
+
+  static constexpr uint64_t kSquare =
+      std::max<uint64_t>(1, (Mod - 1) * (Mod - 1));
+  static constexpr size_t kTerms = std::min<uint64_t>(
+      1 << 20, (std::numeric_limits<uint64_t>::max() - Mod) / kSquare);
+
+#if defined(__AVX2__)
+  static constexpr size_t kRows = 6;
+  static constexpr size_t kCols = 8;
+
+  // _mm256_mul_epu32 перемножает младшие 32 бита: как раз вычеты
+  static void kernel(size_t depth, const uint64_t* a, const uint64_t* b,
+                     uint64_t* tile) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (size_t i = 0; i < 6; ++i) {
+      acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+    }
+    for (size_t begin = 0; begin < depth; begin += kTerms) {
+      size_t end = std::min(depth, begin + kTerms);
+      for (size_t p = begin; p < end; ++p, a += 6, b += 8) {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i second =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 4));
+#pragma GCC unroll 6
+        for (size_t i = 0; i < 6; ++i) {
+          __m256i elem = _mm256_set1_epi64x(a[i]);
+          acc[i][0] =
+              _mm256_add_epi64(acc[i][0], _mm256_mul_epu32(elem, first));
+          acc[i][1] =
+              _mm256_add_epi64(acc[i][1], _mm256_mul_epu32(elem, second));
+        }
+      }
+#pragma GCC unroll 6
+      for (size_t i = 0; i < 6; ++i) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + 8 * i),
+                            acc[i][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + 8 * i + 4),
+                            acc[i][1]);
+      }
+      for (size_t i = 0; i < kRows * kCols; ++i) {
+        tile[i] %= Mod;
+      }
+#pragma GCC unroll 6
+      for (size_t i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(tile + 8 * i));
+        acc[i][1] = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(tile + 8 * i + 4));
+      }
+    }
+  }
+#else
+  static constexpr size_t kRows = 4;
+  static constexpr size_t kCols = 4;
+
+  static void kernel(size_t depth, const uint64_t* a, const uint64_t* b,
+                     uint64_t* tile) {
+    std::fill(tile, tile + kRows * kCols, 0);
+    uint64_t part[kRows * kCols];
+    for (size_t begin = 0; begin < depth; begin += kTerms) {
+      size_t len = std::min(depth - begin, kTerms);
+      scalar_kernel<uint64_t, kRows, kCols>(len, a + begin * kRows,
+                                            b + begin * kCols, part);
+      for (size_t i = 0; i < kRows * kCols; ++i) {
+        tile[i] = (tile[i] + part[i] % Mod) % Mod;
+      }
+    }
+  }
+#endif
+
+  static uint64_t load(const Field& elem) {
+    return elem.value;
+  }
+
+  static void store(Field& elem, uint64_t sum) {
+    elem.value = (elem.value + sum) % Mod;
+  }
+
+  static void subtract(Field& elem, uint64_t sum) {
+    elem.value = (elem.value + Mod - sum) % Mod;
+  }
+};
+
+// C += A * B или, при Subtract, C -= A * B; элемент (i, j) матрицы X
+// лежит в x[i * x_row + j * x_col]. Шаги столбцов нужны только при
+// упаковке и записи плитки, микроядро их не видит.
+//
+// Параллельная единица - плитка C из kBlockRows строк и kGroupCols
+// столбцов внутри блока kBlockCols: панель B общая, свою панель A каждый
+// поток пакует сам в собственный буфер.
+template <typename Traits, bool Subtract, typename Policy, typename Field>
+void packed_gemm(const Policy& policy, size_t n, size_t k, size_t m,
+                 const Field* a, size_t a_row, size_t a_col, const Field* b,
+                 size_t b_row, size_t b_col, Field* c, size_t c_row,
+                 size_t c_col) {
+  using T = typename Traits::value_type;
+  constexpr size_t kRows = Traits::kRows;
+  constexpr size_t kCols = Traits::kCols;
+  constexpr size_t kBlockRows = 96 / kRows * kRows;
+  constexpr size_t kBlockDepth = 256;
+  constexpr size_t kBlockCols = 2048 / kCols * kCols;
+  constexpr size_t kGroupCols = 256 / kCols * kCols;
+
+  // буферы переиспользуются между вызовами, чтобы не трогать заново
+  // мегабайты свежей памяти на каждом шаге блочного разложения
+  static thread_local std::vector<T> pack_b;
+  pack_b.resize(kBlockDepth * kBlockCols);
+
+  for (size_t col = 0; col < m; col += kBlockCols) {
+    size_t cols = std::min(kBlockCols, m - col);
+    for (size_t depth = 0; depth < k; depth += kBlockDepth) {
+      size_t len = std::min(kBlockDepth, k - depth);
+
+      // панели B: kCols столбцов подряд на каждом шаге глубины, хвост нулями
+      for (size_t j = 0; j < cols; j += kCols) {
+        T* panel = pack_b.data() + j * len;
+        size_t width = std::min(kCols, cols - j);
+        for (size_t p = 0; p < len; ++p) {
+          const Field* src = b + (depth + p) * b_row + (col + j) * b_col;
+          for (size_t q = 0; q < kCols; ++q) {
+            panel[p * kCols + q] =
+                q < width ? Traits::load(src[q * b_col]) : T(0);
+          }
+        }
+      }
+
+      size_t groups = (cols + kGroupCols - 1) / kGroupCols;
+      size_t blocks = (n + kBlockRows - 1) / kBlockRows * groups;
+      const T* packed_b = pack_b.data();
+      policy.parallel_for(blocks, 1, [&](size_t begin, size_t end) {
+        static thread_local std::vector<T> pack_a;
+        pack_a.resize(kBlockRows * kBlockDepth);
+        T tile[kRows * kCols];
+
+        for (size_t block = begin; block < end; ++block) {
+          size_t row = block / groups * kBlockRows;
+          size_t rows = std::min(kBlockRows, n - row);
+          size_t group = block % groups * kGroupCols;
+
+          for (size_t i = 0; i < rows; i += kRows) {
+            T* panel = pack_a.data() + i * len;
+            size_t height = std::min(kRows, rows - i);
+            for (size_t q = 0; q < kRows; ++q) {
+              if (q >= height) {
+                for (size_t p = 0; p < len; ++p) {
+                  panel[p * kRows + q] = T(0);
+                }
+                continue;
+              }
+              const Field* src = a + (row + i + q) * a_row + depth * a_col;
+              for (size_t p = 0; p < len; ++p) {
+                panel[p * kRows + q] = Traits::load(src[p * a_col]);
+              }
+            }
+          }
+
+          for (size_t j = group; j < std::min(cols, group + kGroupCols);
+               j += kCols) {
+            size_t width = std::min(kCols, cols - j);
+            for (size_t i = 0; i < rows; i += kRows) {
+              size_t height = std::min(kRows, rows - i);
+              Traits::kernel(len, pack_a.data() + i * len, packed_b + j * len,
+                             tile);
+              for (size_t q = 0; q < height; ++q) {
+                Field* dst = c + (row + i + q) * c_row + (col + j) * c_col;
+                for (size_t r = 0; r < width; ++r) {
+                  if constexpr (Subtract) {
+                    Traits::subtract(dst[r * c_col], tile[q * kCols + r]);
+                  } else {
+                    Traits::store(dst[r * c_col], tile[q * kCols + r]);
+                  }
+                }
+              }
+            }
+          }
+        }
+      });
+    }
+  }
+}
+}  // namespace detail
+
+template <>
+struct gemm_traits<double> : detail::float_gemm_traits<double> {};
+
+template <>
+struct gemm_traits<float> : detail::float_gemm_traits<float> {};
+
+// Меньше этого числа умножений упаковка не окупается.
+const size_t kPackedGemmThreshold = 32 * 32 * 32;
+
+namespace detail {
+template <bool Subtract, typename Policy, typename Field>
+void gemm_update(const Policy& policy, size_t n, size_t k, size_t m,
+                 const Field* a, size_t a_row, size_t a_col, const Field* b,
+                 size_t b_row, size_t b_col, Field* c, size_t c_row,
+                 size_t c_col) {
+  if constexpr (gemm_traits<Field>::packed) {
+    if (n * k * m >= kPackedGemmThreshold) {
+      packed_gemm<gemm_traits<Field>, Subtract>(policy, n, k, m, a, a_row,
+                                                a_col, b, b_row, b_col, c,
+                                                c_row, c_col);
+      return;
+    }
+  }
+
+  // строки C независимы; мелкие произведения не дробятся. Единичные шаги
+  // столбцов B и C - отдельный экземпляр, чтобы внутренний цикл
+  // векторизовался.
+  size_t grain = n * k * m >= kPackedGemmThreshold ? 8 : n;
+  auto update = [&](auto b_step, auto c_step) {
+    policy.parallel_for(n, grain, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        Field* row = c + i * c_row;
+        for (size_t p = 0; p < k; ++p) {
+          const Field& elem = a[i * a_row + p * a_col];
+          const Field* other = b + p * b_row;
+          for (size_t j = 0; j < m; ++j) {
+            if constexpr (Subtract) {
+              row[j * c_step] -= elem * other[j * b_step];
+            } else {
+              row[j * c_step] += elem * other[j * b_step];
+            }
+          }
+        }
+      }
+    });
+  };
+  if (b_col == 1 && c_col == 1) {
+    update(std::integral_constant<size_t, 1>(),
+           std::integral_constant<size_t, 1>());
+  } else {
+    update(b_col, c_col);
+  }
+}
+
+template <bool Subtract, typename Policy, typename Field>
+void gemm_update(const Policy& policy, size_t n, size_t k, size_t m,
+                 const Field* a, size_t lda, const Field* b, size_t ldb,
+                 Field* c, size_t ldc) {
+  gemm_update<Subtract>(policy, n, k, m, a, lda, 1, b, ldb, 1, c, ldc, 1);
+}
+}  // namespace detail
+
+template <typename Policy, typename Field>
+void gemm(const Policy& policy, size_t n, size_t k, size_t m, const Field* a,
+          size_t lda, const Field* b, size_t ldb, Field* c, size_t ldc) {
+  for (size_t i = 0; i < n; ++i) {
+    std::fill(c + i * ldc, c + i * ldc + m, Field(0));
+  }
+  detail::gemm_update<false>(policy, n, k, m, a, lda, b, ldb, c, ldc);
+}
+
+template <typename Field>
+void gemm(size_t n, size_t k, size_t m, const Field* a, size_t lda,
+          const Field* b, size_t ldb, Field* c, size_t ldc) {
+  gemm(seq, n, k, m, a, lda, b, ldb, c, ldc);
+}
+
+// C -= A * B; нужно для обновления хвоста в блочных разложениях.
+template <typename Policy, typename Field>
+void gemm_subtract(const Policy& policy, size_t n, size_t k, size_t m,
+                   const Field* a, size_t lda, const Field* b, size_t ldb,
+                   Field* c, size_t ldc) {
+  detail::gemm_update<true>(policy, n, k, m, a, lda, b, ldb, c, ldc);
+}
+
+template <typename Field>
+void gemm_subtract(size_t n, size_t k, size_t m, const Field* a, size_t lda,
+                   const Field* b, size_t ldb, Field* c, size_t ldc) {
+  gemm_subtract(seq, n, k, m, a, lda, b, ldb, c, ldc);
+}
+}  // namespace my
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "dynamic_matrix.h"
+#include "gauss.h"
+#include "matrix.h"
+
+// Разложение PA = LU, посчитанное один раз: det, решения систем и
+// обратная матрица берутся из него без повторного метода Гаусса. Для
+// вырожденных матриц solve и inverse бросают std::domain_error.
+template <typename Field = Rational>
+class LUDecomposition {
+ private:
+  DynamicMatrix<Field> lu_;
+  std::vector<size_t> perm_;
+  bool inversions_ = false;
+  bool singular_ = false;
+
+  template <typename Policy>
+  void factor(const Policy& policy) {
+    if (lu_.rows() != lu_.cols()) {
+      throw std::invalid_argument("LUDecomposition: matrix not square");
+    }
+    perm_.resize(lu_.rows());
+    inversions_ = my::detail::lu_factor(policy, lu_.data(), lu_.stride(),
+                                        size(), perm_.data());
+
+    const Field zero(0);
+    for (size_t i = 0; i < size(); ++i) {
+      singular_ = singular_ || lu_[i][i] == zero;
+    }
+  }
+
+  void check_singular() const {
+    if (singular_) {
+      throw std::domain_error("LUDecomposition: singular matrix");
+    }
+  }
+
+ public:
+  // policy - my::seq или my::par (thread_pool.h)
+  template <typename Policy = my::sequenced_policy>
+  explicit LUDecomposition(DynamicMatrix<Field>&& matrix,
+                           const Policy& policy = my::seq)
+      : lu_(std::move(matrix)) {
+    factor(policy);
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  explicit LUDecomposition(const DynamicMatrix<Field>& matrix,
+                           const Policy& policy = my::seq)
+      : LUDecomposition(matrix.clone(), policy) {}
+
+  template <size_t N, typename Policy = my::sequenced_policy>
+  explicit LUDecomposition(const Matrix<N, N, Field>& matrix,
+                           const Policy& policy = my::seq)
+      : LUDecomposition(DynamicMatrix<Field>(matrix), policy) {}
+
+  size_t size() const {
+    return lu_.rows();
+  }
+
+  bool isSingular() const {
+    return singular_;
+  }
+
+  // L под диагональю (без единичной диагонали), U на диагонали и выше
+  const DynamicMatrix<Field>& packed() const {
+    return lu_;
+  }
+
+  // строка i разложения - строка perm[i] исходной матрицы
+  const std::vector<size_t>& permutation() const {
+    return perm_;
+  }
+
+  Field det() const {
+    return my::detail::lu_det(lu_.data(), lu_.stride(), size(), inversions_);
+  }
+
+  std::vector<Field> solve(const std::vector<Field>& b) const {
+    check_singular();
+    if (b.size() != size()) {
+      throw std::invalid_argument("LUDecomposition::solve: size mismatch");
+    }
+
+    std::vector<Field> ans(size());
+    my::detail::lu_solve(my::seq, lu_.data(), lu_.stride(), size(),
+                         perm_.data(), b.data(), 1, ans.data(), 1, 1);
+    return ans;
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  DynamicMatrix<Field> solve_many(const DynamicMatrix<Field>& b,
+                                  const Policy& policy = my::seq) const {
+    check_singular();
+    if (b.rows() != size()) {
+      throw std::invalid_argument(
+          "LUDecomposition::solve_many: size mismatch");
+    }
+
+    DynamicMatrix<Field> ans(b.rows(), b.cols());
+    my::detail::lu_solve(policy, lu_.data(), lu_.stride(), size(),
+                         perm_.data(), b.data(), b.stride(), ans.data(),
+                         ans.stride(), b.cols());
+    return ans;
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  DynamicMatrix<Field> inverse(const Policy& policy = my::seq) const {
+    return solve_many(DynamicMatrix<Field>::unityMatrix(size()), policy);
+  }
+};
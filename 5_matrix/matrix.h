@@ -1,9 +1,20 @@
+#pragma once
+
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <deque>
 #include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <utility>
+
+#include "expression.h"
+#include "gauss.h"
+#include "gemm.h"
+#include "modulus.h"
+#include "view.h"
 
 struct Rational {
   long double value;
@@ -102,24 +113,55 @@ std::ostream& operator<<(std::ostream& output, const Rational& elem) {
   return output;
 }
 
-template <size_t N, size_t M = 2, bool flag_ = false>
+template <size_t N>
 struct is_prime {
-  constexpr static bool value = (M * M <= N ? N % M != 0 : true) &&
-                                is_prime<N, M + 1, (M * M > N)>::value;
+  constexpr static bool value = my::modulus_traits<N>::is_prime;
 };
 
-template <size_t N, size_t M>
-struct is_prime<N, M, true> {
-  constexpr static bool value = true;
+namespace my::detail {
+// Умножение вычетов по модулю N без переполнения: при N <= 2^16
+// произведение помещается в 32 бита, иначе считается в 64. Модуль -
+// константа времени компиляции, поэтому % N компилятор сам заменяет
+// умножением на заранее посчитанное обратное (то же сокращение Барретта),
+// и это быстрее, чем Барретт, написанный вручную.
+template <size_t N, bool Small = (my::modulus_traits<N>::bits <= 16)>
+struct modular_reduction {
+  static uint32_t multiply(uint32_t first, uint32_t second) {
+    return first * second % N;
+  }
 };
 
-template <>
-struct is_prime<1> {
-  constexpr static bool value = false;
+template <size_t N>
+struct modular_reduction<N, false> {
+  static uint32_t multiply(uint32_t first, uint32_t second) {
+    return uint64_t(first) * second % N;
+  }
 };
 
+// Обратный к value по модулю N расширенным алгоритмом Евклида, O(log N).
+// Если обратного нет (value = 0), возвращает 0, как и раньше.
+template <size_t N>
+int modular_inverse(int value) {
+  int64_t coef = 0;
+  int64_t next_coef = 1;
+  int64_t rest = N;
+  int64_t next_rest = value;
+  while (next_rest != 0) {
+    int64_t quotient = rest / next_rest;
+    coef = std::exchange(next_coef, coef - quotient * next_coef);
+    rest = std::exchange(next_rest, rest - quotient * next_rest);
+  }
+  if (rest != 1) {
+    return 0;
+  }
+  return coef < 0 ? coef + N : coef;
+}
+}  // namespace my::detail
+
 template <size_t N>
 class Residue {
+  static_assert(N >= 1 && N - 1 <= std::numeric_limits<int>::max());
+
  public:
   int value;
 
@@ -136,28 +178,26 @@ class Residue {
   }
 
   Residue& operator+=(const Residue& other) {
-    (value += other.value) %= N;
+    uint32_t sum = uint32_t(value) + other.value;
+    value = sum >= N ? sum - N : sum;
     return *this;
   }
 
   Residue& operator-=(const Residue& other) {
-    ((value -= other.value) += N) %= N;
+    value = value >= other.value ? value - other.value
+                                 : value + (N - other.value);
     return *this;
   }
 
   Residue& operator*=(const Residue& other) {
-    (value *= other.value) %= N;
+    value = my::detail::modular_reduction<N>::multiply(value, other.value);
     return *this;
   }
 
   Residue& operator/=(const Residue& other) {  // devision by zero
     static_assert(is_prime<N>::value);
 
-    for (size_t i = 0; i < N - 2; ++i) {
-      (value *= other.value) %= N;
-    }
-
-    return *this;
+    return *this *= Residue(my::detail::modular_inverse<N>(other.value));
   }
 };
 
@@ -217,83 +257,16 @@ Residue<N> operator/(const Residue<N>& first, const Residue<N>& second) {
   return cnt;
 }
 
+namespace my {
+template <size_t N>
+struct gemm_traits<Residue<N>> : detail::modular_gemm_traits<Residue<N>, N> {};
+}  // namespace my
+
 template <size_t N, size_t M, typename Field = Rational>
 class Matrix {
  private:
   std::array<std::array<Field, M>, N> matrix;
 
-  template <size_t K>
-  std::pair<bool, Matrix<N, K, Field>> step_view(
-      const Matrix<N, K, Field>& matrix) const {
-    bool inversions = false;
-    size_t row = 0;
-    size_t collum = 0;
-
-    Matrix<N, K, Field> ans_matrix = matrix;
-
-    Field zero;
-    zero -= zero;  // нашёл 0 в поле
-
-    while (row < N && collum < M) {
-      bool find_non_zero_elem = false;
-
-      for (size_t i = row; i < N; ++i) {
-        if (ans_matrix[i][collum] != zero) {
-          if (i != row) {
-            inversions = !inversions;
-
-            for (size_t j = collum; j < K; ++j) {
-              std::swap(ans_matrix[i][j], ans_matrix[row][j]);
-            }
-          }
-
-          find_non_zero_elem = true;
-          break;
-        }
-      }
-
-      if (!find_non_zero_elem) {
-        ++collum;
-        continue;
-      }
-
-      for (size_t i = row + 1; i < N; ++i) {
-        Field koef = ans_matrix[i][collum] / ans_matrix[row][collum];
-        for (size_t j = collum; j < K; ++j) {
-          ans_matrix[i][j] -= koef * ans_matrix[row][j];
-        }
-      }
-      ++row;
-      ++collum;
-    }
-
-    return std::make_pair(inversions, ans_matrix);
-  }
-
-  template <size_t K>
-  Matrix<N, K, Field> reverse_gausse(const Matrix<N, K, Field>& matrix) const {
-    Matrix<N, K, Field> ans = matrix;
-    for (size_t i = N; i > 0; --i) {
-      Field koeff = Field(1) / ans[i - 1][i - 1];
-
-      ans[i - 1][i - 1] = Field(1);
-
-      for (size_t j = N + 1; j <= K; ++j) {
-        ans[i - 1][j - 1] *= koeff;
-      }
-
-      for (size_t j = i - 1; j > 0; --j) {
-        Field one_more_koeff = ans[j - 1][i - 1] / ans[i - 1][i - 1];
-
-        ans[j - 1][i - 1] = Field(0);
-        for (size_t k = N + 1; k <= K; ++k) {
-          ans[j - 1][k - 1] -= one_more_koeff * ans[i - 1][k - 1];
-        }
-      }
-    }
-    return ans;
-  }
-
  public:
   Matrix() = default;
 
@@ -307,8 +280,26 @@ class Matrix {
     }
   }
 
+  // вычисляет выражение A + B - C * k одним проходом
+  template <my::detail::matrix_expression Expr>
+  Matrix(const Expr& expr) {
+    *this = expr;
+  }
+
   Matrix& operator=(const Matrix<N, M, Field>&) = default;
 
+  template <my::detail::matrix_expression Expr>
+  Matrix& operator=(const Expr& expr) {
+    static_assert(my::detail::same_shape<Matrix, Expr>);
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < M; ++j) {
+        matrix[i][j] = expr.at(i, j);
+      }
+    }
+
+    return *this;
+  }
+
   static Matrix unityMatrix() {
     static_assert(N == M);
 
@@ -342,20 +333,24 @@ class Matrix {
     return matrix[i];
   }
 
-  Matrix& operator+=(const Matrix<N, M, Field>& other) {
+  template <typename Other>
+    requires my::detail::same_shape<Matrix, Other>
+  Matrix& operator+=(const Other& other) {
     for (size_t i = 0; i < N; ++i) {
       for (size_t j = 0; j < M; ++j) {
-        matrix[i][j] += other[i][j];
+        matrix[i][j] += my::detail::element(other, i, j);
       }
     }
 
     return *this;
   }
 
-  Matrix& operator-=(const Matrix<N, M, Field>& other) {
+  template <typename Other>
+    requires my::detail::same_shape<Matrix, Other>
+  Matrix& operator-=(const Other& other) {
     for (size_t i = 0; i < N; ++i) {
       for (size_t j = 0; j < M; ++j) {
-        matrix[i][j] -= other[i][j];
+        matrix[i][j] -= my::detail::element(other, i, j);
       }
     }
 
@@ -393,15 +388,51 @@ class Matrix {
     return ans;
   }
 
+  // Виды без копирования: view.h. Действительны, пока жива матрица.
+  my::MatrixView<Field> view() {
+    return my::MatrixView<Field>(N == 0 ? nullptr : matrix[0].data(), N, M,
+                                 M);
+  }
+
+  my::MatrixView<const Field> view() const {
+    return my::MatrixView<const Field>(N == 0 ? nullptr : matrix[0].data(),
+                                       N, M, M);
+  }
+
+  my::VectorView<Field> row(size_t i) {
+    return view().row(i);
+  }
+
+  my::VectorView<const Field> row(size_t i) const {
+    return view().row(i);
+  }
+
+  my::VectorView<Field> column(size_t j) {
+    return view().column(j);
+  }
+
+  my::VectorView<const Field> column(size_t j) const {
+    return view().column(j);
+  }
+
+  my::MatrixView<Field> block(size_t row, size_t col, size_t rows,
+                              size_t cols) {
+    return view().block(row, col, rows, cols);
+  }
+
+  my::MatrixView<const Field> block(size_t row, size_t col, size_t rows,
+                                    size_t cols) const {
+    return view().block(row, col, rows, cols);
+  }
+
+  my::MatrixView<const Field> transposedView() const {
+    return view().transposed();
+  }
+
   Field trace() const {
     static_assert(N == M);
 
-    Field ans(0);
-    for (size_t i = 0; i < N; ++i) {
-      ans += matrix[i][i];
-    }
-
-    return ans;
+    return view().trace();
   }
 
   Matrix<M, N, Field> transposed() const {
@@ -415,65 +446,34 @@ class Matrix {
     return ans;
   }
 
-  Field det() const {
+  // policy - my::seq или my::par (thread_pool.h)
+  template <typename Policy = my::sequenced_policy>
+  Field det(const Policy& policy = my::seq) const {
     static_assert(N == M);
 
-    auto gausse_matrix = step_view<M>(*this);
-    Field ans(1);
-    for (size_t i = 0; i < N; ++i) {
-      ans *= gausse_matrix.second[i][i];
-    }
-    return Field(gausse_matrix.first ? -1 : 1) * ans;
+    Matrix copy = *this;
+    return my::detail::det(policy, copy[0].data(), M, N);
   }
 
-  size_t rank() const {
-    auto gausse_matrix = step_view<M>(*this).second;
-
-    size_t ans = 0;
-
-    Field zero;
-    zero -= zero;
-
-    for (size_t i = 0; i < N; ++i) {
-      bool non_zero_row = false;
-      for (size_t j = i; j < M; ++j) {
-        if (gausse_matrix[i][j] != zero) {
-          non_zero_row = true;
-          break;
-        }
-      }
-      ans += non_zero_row;
-    }
-
-    return ans;
+  template <typename Policy = my::sequenced_policy>
+  size_t rank(const Policy& policy = my::seq) const {
+    Matrix copy = *this;
+    return my::detail::rank(policy, copy[0].data(), M, N, M);
   }
 
-  Matrix inverted() const {
+  template <typename Policy = my::sequenced_policy>
+  Matrix inverted(const Policy& policy = my::seq) const {
     static_assert(N == M);
 
-    Matrix<N, 2 * N, Field> extended_matrix;
-
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < N; ++j) {
-        extended_matrix[i][j] = (*this)[i][j];
-        extended_matrix[i][j + N] = Field(i == j ? 1 : 0);
-      }
-    }
-    auto gausse_matrix =
-        reverse_gausse<2 * N>(step_view<2 * N>(extended_matrix).second);
     Matrix ans;
-
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < N; ++j) {
-        ans[i][j] = gausse_matrix[i][j + N];
-      }
-    }
-
+    my::detail::inverse(policy, matrix[0].data(), N, N, ans[0].data(),
+                        N);
     return ans;
   }
 
-  Matrix& invert() {
-    return *this = inverted();
+  template <typename Policy = my::sequenced_policy>
+  Matrix& invert(const Policy& policy = my::seq) {
+    return *this = inverted(policy);
   }
 };
 
@@ -490,58 +490,38 @@ std::ostream& operator<<(std::ostream& output,
   return output;
 }
 
-template <size_t N, size_t M, typename Field = Rational>
-Matrix<N, M> operator+(const Matrix<N, M, Field>& first,
-                       const Matrix<N, M, Field>& second) {
-  Matrix<N, M, Field> cnt = first;
-  cnt += second;
-
-  return cnt;
-}
-
-template <size_t N, size_t M, typename Field = Rational>
-Matrix<N, M, Field> operator-(const Matrix<N, M, Field>& first,
-                              const Matrix<N, M, Field>& second) {
-  Matrix<N, M, Field> cnt = first;
-  cnt -= second;
-
-  return cnt;
-}
-
-template <size_t N, size_t M, typename Field = Rational>
-Matrix<N, M, Field> operator*(const Matrix<N, M, Field>& matrix,
-                              const Field& elem) {
-  Matrix<N, M, Field> cnt = matrix;
-  cnt *= elem;
-
-  return cnt;
-}
+namespace my {
+// Произведение с заданной политикой: my::multiply(my::par, a, b).
+template <typename Policy, size_t N, size_t K, size_t M, typename Field>
+Matrix<N, M, Field> multiply(const Policy& policy,
+                             const Matrix<N, K, Field>& first,
+                             const Matrix<K, M, Field>& second) {
+  Matrix<N, M, Field> ans_matrix;
+  if constexpr (N != 0 && K != 0 && M != 0) {
+    // строки std::array<std::array> лежат подряд, шаг строки - K или M
+    static_assert(sizeof(std::array<Field, K>) == K * sizeof(Field));
+    gemm(policy, N, K, M, first[0].data(), K, second[0].data(), M,
+         ans_matrix[0].data(), M);
+  } else {
+    ans_matrix = Matrix<N, M, Field>();
+  }
 
-template <size_t N, size_t M, typename Field = Rational>
-Matrix<N, M, Field> operator*(const Field& elem,
-                              const Matrix<N, M, Field>& matrix) {
-  return matrix * elem;
+  return ans_matrix;
 }
+}  // namespace my
 
 template <size_t N, size_t K, size_t M, typename Field = Rational>
 Matrix<N, M, Field> operator*(const Matrix<N, K, Field>& first,
                               const Matrix<K, M, Field>& second) {
-  Matrix<N, M, Field> ans_matrix;
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      std::array<Field, K> row = first.getRow(i);
-      std::array<Field, K> collum = second.getColumn(j);
-
-      Field product(0);
-      for (size_t k = 0; k < K; ++k) {
-        product += row[k] * collum[k];
-      }
-
-      ans_matrix[i][j] = product;
-    }
-  }
+  return my::multiply(my::seq, first, second);
+}
 
-  return ans_matrix;
+// Произведение с выражением: множитель-выражение вычисляется один раз.
+template <my::detail::matrix_operand First, my::detail::matrix_operand Second>
+  requires(my::detail::matrix_expression<First> ||
+           my::detail::matrix_expression<Second>)
+auto operator*(const First& first, const Second& second) {
+  return my::detail::evaluate(first) * my::detail::evaluate(second);
 }
 
 template <size_t N, typename Field = Rational>
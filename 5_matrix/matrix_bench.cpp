@@ -0,0 +1,192 @@
+// Замеры производительности матриц.
+//
+//   g++ -std=c++20 -O2 -mavx2 -mfma -pthread matrix_bench.cpp -o matrix_bench
+//   ./matrix_bench [all|sizes|threads] [max_threads]
+//
+// sizes - умножение, det, rank, inverted и transposed от 4 x 4 до
+// 1024 x 1024 для float, double, Rational и Residue с малым и большим
+// модулем: мкс на операцию и миллиарды операций поля в секунду (для
+// transposed - перенесённых элементов). До 64 x 64 меряется Matrix, дальше
+// DynamicMatrix: большая Matrix не помещается на стек.
+//
+// threads - умножение и LU (det + обратная) для double и
+// Residue<10^9 + 7> на пуле из 1..N потоков: время, GFLOPS и ускорение
+// относительно одного потока.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "dynamic_matrix.h"
+#include "lu.h"
+#include "matrix.h"
+
+namespace {
+const size_t kSize = 1536;
+const double kMinTime = 0.2;
+
+volatile double sink = 0;
+
+template <typename Func>
+double seconds(Func func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+template <typename Field>
+DynamicMatrix<Field> random_matrix(size_t n, std::mt19937& gen) {
+  std::uniform_int_distribution<int> value(-1000, 1000);
+  DynamicMatrix<Field> matrix(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      matrix[i][j] = Field(value(gen));
+    }
+  }
+  return matrix;
+}
+
+// Повторяет func удваивающимися пачками, пока не наберётся kMinTime.
+// ops - операций поля за один вызов.
+template <typename Func>
+void report(const std::string& name, size_t n, double ops, Func func) {
+  size_t calls = 0;
+  double time = 0;
+  for (size_t batch = 1; time < kMinTime; batch *= 2) {
+    time += seconds([&]() {
+      for (size_t i = 0; i < batch; ++i) {
+        func();
+      }
+    });
+    calls += batch;
+  }
+
+  double per_call = time / calls;
+  std::printf("  %-12s %5zu %14.1f us/op %9.3f Gop/s\n", name.c_str(), n,
+              per_call * 1e6, ops / per_call * 1e-9);
+}
+
+template <size_t N, typename Field>
+std::unique_ptr<Matrix<N, N, Field>> random_static(std::mt19937& gen) {
+  std::uniform_int_distribution<int> value(-1000, 1000);
+  auto matrix = std::make_unique<Matrix<N, N, Field>>();
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      (*matrix)[i][j] = Field(value(gen));
+    }
+  }
+  return matrix;
+}
+
+// Умножение - n^3 умножений-сложений, det и rank - n^3 / 3, обращение
+// (разложение и n правых частей) - 4 n^3 / 3; по две операции поля на
+// умножение-сложение.
+template <typename MatrixType>
+void bench_ops(size_t n, const MatrixType& first, const MatrixType& second) {
+  const double cube = 2.0 * n * n * n;
+  report("multiply", n, cube, [&]() {
+    auto ans = first * second;
+    sink = sink + (ans[0][0] == ans[n - 1][n - 1]);
+  });
+  report("det", n, cube / 3, [&]() {
+    auto ans = first.det();
+    sink = sink + (ans == first[0][0]);
+  });
+  report("rank", n, cube / 3, [&]() { sink = sink + first.rank(); });
+  report("inverted", n, cube * 4 / 3, [&]() {
+    auto ans = first.inverted();
+    sink = sink + (ans[0][0] == ans[n - 1][n - 1]);
+  });
+  report("transposed", n, double(n) * n, [&]() {
+    auto ans = first.transposed();
+    sink = sink + (ans[0][n - 1] == first[n - 1][0]);
+  });
+}
+
+template <typename Field, size_t N>
+void bench_static(std::mt19937& gen) {
+  auto first = random_static<N, Field>(gen);
+  auto second = random_static<N, Field>(gen);
+  bench_ops(N, *first, *second);
+}
+
+template <typename Field>
+void bench_sizes(const std::string& name, std::mt19937& gen) {
+  std::printf("%s\n", name.c_str());
+  bench_static<Field, 4>(gen);
+  bench_static<Field, 16>(gen);
+  bench_static<Field, 64>(gen);
+  for (size_t n : {256, 1024}) {
+    DynamicMatrix<Field> first = random_matrix<Field>(n, gen);
+    DynamicMatrix<Field> second = random_matrix<Field>(n, gen);
+    bench_ops(n, first, second);
+  }
+}
+
+// flops - число умножений-сложений, по два флопа каждое
+template <typename Func>
+void scaling(const std::string& name, double flops, size_t max_threads,
+             Func func) {
+  std::printf("%s\n", name.c_str());
+  double single = 0;
+  for (size_t threads = 1; threads <= max_threads; ++threads) {
+    my::ThreadPool pool(threads);
+    auto policy = my::par.on(pool);
+    func(policy);  // прогрев: буферы упаковки и потоки пула
+    double time = seconds([&]() { func(policy); });
+    if (threads == 1) {
+      single = time;
+    }
+    std::printf("  threads %2zu: %8.3f s  %7.2f GFLOPS  speedup %.2f\n",
+                threads, time, 2 * flops / time * 1e-9, single / time);
+  }
+}
+
+template <typename Field>
+void bench_field(const std::string& name, size_t max_threads,
+                 std::mt19937& gen) {
+  const double n = kSize;
+  DynamicMatrix<Field> first = random_matrix<Field>(kSize, gen);
+  DynamicMatrix<Field> second = random_matrix<Field>(kSize, gen);
+
+  scaling(name + " multiply " + std::to_string(kSize), n * n * n,
+          max_threads, [&](const auto& policy) {
+            DynamicMatrix<Field> ans = my::multiply(policy, first, second);
+            sink = sink + (ans[0][0] == Field(0));
+          });
+
+  // LU - n^3 / 3, решение для n правых частей - n^3
+  scaling(name + " LU det + inverse " + std::to_string(kSize),
+          n * n * n * 4 / 3, max_threads, [&](const auto& policy) {
+            LUDecomposition<Field> lu(first, policy);
+            DynamicMatrix<Field> inverse = lu.inverse(policy);
+            sink = sink + (lu.det() == Field(0)) + (inverse[0][0] == Field(0));
+          });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* mode = argc > 1 ? argv[1] : "all";
+  size_t max_threads =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : my::default_threads();
+  bool all = std::strcmp(mode, "all") == 0;
+
+  std::mt19937 gen(2024);
+  if (all || std::strcmp(mode, "sizes") == 0) {
+    bench_sizes<float>("float", gen);
+    bench_sizes<double>("double", gen);
+    bench_sizes<Rational>("Rational", gen);
+    bench_sizes<Residue<10007>>("Residue<10007>", gen);
+    bench_sizes<Residue<1000000007>>("Residue<1e9+7>", gen);
+  }
+  if (all || std::strcmp(mode, "threads") == 0) {
+    bench_field<double>("double", max_threads, gen);
+    bench_field<Residue<1000000007>>("Residue<1e9+7>", max_threads, gen);
+  }
+}
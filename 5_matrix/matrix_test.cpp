@@ -0,0 +1,896 @@
+// Тесты матриц.
+//
+//   g++ -std=c++20 -O2 -mavx2 -mfma -pthread matrix_test.cpp -o matrix_test
+//   ./matrix_test
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "dynamic_matrix.h"
+#include "exact.h"
+#include "lu.h"
+#include "matrix.h"
+#include "recurrence.h"
+#include "sparse.h"
+#include "strassen.h"
+#include "thread_pool.h"
+
+using Mod = Residue<1000000007>;
+
+template <typename Field>
+DynamicMatrix<Field> random_matrix(size_t rows, size_t cols,
+                                   std::mt19937& gen) {
+  std::uniform_int_distribution<int> value(-1000, 1000);
+  DynamicMatrix<Field> matrix(rows, cols);
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      matrix[i][j] = Field(value(gen));
+    }
+  }
+  return matrix;
+}
+
+template <typename Func>
+bool throws_domain_error(Func func) {
+  try {
+    func();
+  } catch (const std::domain_error&) {
+    return true;
+  }
+  return false;
+}
+
+// L * U из упакованного разложения против строк A в порядке перестановки.
+template <typename Field, typename Equal>
+void CheckReconstruction(const DynamicMatrix<Field>& matrix,
+                         const LUDecomposition<Field>& lu, Equal equal) {
+  size_t n = lu.size();
+  const DynamicMatrix<Field>& packed = lu.packed();
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      Field sum = i <= j ? packed[i][j] : Field(0);
+      for (size_t k = 0; k < std::min(i, j + 1); ++k) {
+        sum += packed[i][k] * packed[k][j];
+      }
+      assert(equal(sum, matrix[lu.permutation()[i]][j]));
+    }
+  }
+}
+
+void TestLU() {
+  std::mt19937 gen(40);
+  auto exact = [](const Mod& first, const Mod& second) {
+    return first == second;
+  };
+  auto close = [](double first, double second) {
+    return std::abs(first - second) <= 1e-9 * std::max(1., std::abs(second));
+  };
+
+  // 150 и 200 - больше блока разложения: проверяется обновление хвоста
+  for (size_t n : {1, 5, 64, 150, 200}) {
+    DynamicMatrix<Mod> matrix = random_matrix<Mod>(n, n, gen);
+    LUDecomposition<Mod> lu(matrix);
+    CheckReconstruction(matrix, lu, exact);
+    LUDecomposition<Mod> parallel(matrix, my::par);
+    assert(parallel.packed() == lu.packed());
+
+    // A x = b и A A^-1 = E
+    std::vector<Mod> b(n);
+    for (size_t i = 0; i < n; ++i) {
+      b[i] = Mod(int(i * i + 1));
+    }
+    std::vector<Mod> x = lu.solve(b);
+    for (size_t i = 0; i < n; ++i) {
+      Mod sum(0);
+      for (size_t j = 0; j < n; ++j) {
+        sum += matrix[i][j] * x[j];
+      }
+      assert(sum == b[i]);
+    }
+    assert(matrix * lu.inverse() == DynamicMatrix<Mod>::unityMatrix(n));
+    assert(matrix.inverted(my::par) == lu.inverse());
+    assert(lu.det() == matrix.det());
+  }
+
+  for (size_t n : {3, 100}) {
+    DynamicMatrix<double> matrix = random_matrix<double>(n, n, gen);
+    LUDecomposition<double> lu(matrix);
+    CheckReconstruction(matrix, lu, close);
+  }
+
+  // PA = LU с перестановкой: первый столбец начинается с нуля
+  Matrix<3, 3, Mod> pivoted({{0, 2, 1}, {3, 1, 4}, {1, 5, 9}});
+  LUDecomposition<Mod> lu_pivoted(pivoted);
+  assert(lu_pivoted.permutation()[0] != 0);
+  assert(lu_pivoted.det() == pivoted.det());
+  CheckReconstruction(DynamicMatrix<Mod>(pivoted), lu_pivoted, exact);
+}
+
+void TestSingular() {
+  // третья строка - сумма первых двух
+  Matrix<3, 3, Mod> matrix({{1, 2, 3}, {4, 5, 6}, {5, 7, 9}});
+  DynamicMatrix<Mod> dynamic(matrix);
+  LUDecomposition<Mod> lu(matrix);
+
+  assert(lu.isSingular());
+  assert(lu.det() == Mod(0) && matrix.det() == Mod(0));
+  assert(matrix.rank() == 2);
+  assert(throws_domain_error([&]() { lu.solve({1, 2, 3}); }));
+  assert(throws_domain_error([&]() { lu.inverse(); }));
+  // inverted идёт тем же разложением и так же бросает, а не возвращает
+  // нули (Residue) или inf (double)
+  assert(throws_domain_error([&]() { matrix.inverted(); }));
+  assert(throws_domain_error([&]() { dynamic.inverted(); }));
+  assert(throws_domain_error([&]() { dynamic.invert(); }));
+
+  Matrix<2, 2, double> flat({{1, 2}, {2, 4}});
+  assert(throws_domain_error([&]() { flat.inverted(); }));
+
+  // вырожденность в середине большой матрицы, после нескольких блоков
+  std::mt19937 gen(41);
+  DynamicMatrix<Mod> big = random_matrix<Mod>(150, 150, gen);
+  for (size_t j = 0; j < 150; ++j) {
+    big[100][j] = big[3][j] + big[70][j] * Mod(2);
+  }
+  assert(LUDecomposition<Mod>(big).isSingular());
+  assert(big.det() == Mod(0) && big.rank() == 149);
+  assert(throws_domain_error([&]() { big.inverted(my::par); }));
+}
+
+// n x n: диагональ и ещё per_row случайных элементов в строке
+template <typename Field>
+SparseMatrix<Field> random_sparse(size_t n, size_t per_row,
+                                  std::mt19937& gen) {
+  std::uniform_int_distribution<size_t> column(0, n - 1);
+  std::uniform_int_distribution<int> value(1, 1000);
+  std::vector<typename SparseMatrix<Field>::Triplet> triplets;
+  for (size_t i = 0; i < n; ++i) {
+    triplets.emplace_back(i, i, Field(value(gen)));
+    for (size_t k = 0; k < per_row; ++k) {
+      triplets.emplace_back(i, column(gen), Field(value(gen)));
+    }
+  }
+  return SparseMatrix<Field>(n, n, triplets);
+}
+
+template <typename Field>
+void CheckWiedemann(size_t n, size_t per_row, std::mt19937& gen) {
+  SparseMatrix<Field> matrix = random_sparse<Field>(n, per_row, gen);
+  std::vector<Field> b(n);
+  std::uniform_int_distribution<int> value(0, 1000);
+  for (auto& elem : b) {
+    elem = Field(value(gen));
+  }
+
+  std::vector<Field> x = my::wiedemann_solve(matrix, b);
+  assert(matrix * x == b);
+  assert(my::wiedemann_solve(matrix, b, my::par) == x);
+  // решение единственно: то же даёт LU плотной матрицы
+  assert(LUDecomposition<Field>(matrix.toDense()).solve(b) == x);
+}
+
+void TestWiedemann() {
+  std::mt19937 gen(47);
+  for (size_t n : {1, 2, 10, 200}) {
+    CheckWiedemann<Mod>(n, 4, gen);
+  }
+  // малое поле: случайная проекция чаще теряет часть многочлена
+  CheckWiedemann<Residue<10007>>(60, 3, gen);
+
+  // b = 0 и единичная матрица
+  SparseMatrix<Mod> unity = SparseMatrix<Mod>::unityMatrix(5);
+  std::vector<Mod> zero(5, Mod(0));
+  assert(my::wiedemann_solve(unity, zero) == zero);
+  std::vector<Mod> b = {1, 2, 3, 4, 5};
+  assert(my::wiedemann_solve(unity, b) == b);
+
+  // вырожденная: вторая строка равна первой
+  SparseMatrix<Mod> singular(3, 3, {{0, 0, Mod(1)},
+                                    {0, 1, Mod(2)},
+                                    {1, 0, Mod(1)},
+                                    {1, 1, Mod(2)},
+                                    {2, 2, Mod(3)}});
+  assert(throws_domain_error(
+      [&]() { my::wiedemann_solve(singular, {Mod(1), Mod(2), Mod(3)}); }));
+
+  bool thrown = false;
+  try {
+    my::wiedemann_solve(SparseMatrix<Mod>(2, 3), {Mod(1), Mod(2)});
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void TestExactDeterminant() {
+  // произведения до деления в Bareiss порядка 10^22 - больше long long
+  Matrix<8, 8, long long> known({{-26, -8, -4, 29, -23, -10, 18, 5},
+                                 {2, 21, -27, 13, -28, 18, 17, -13},
+                                 {-21, -1, 16, -28, 10, 4, 2, -16},
+                                 {24, 27, 8, -12, 6, -7, -5, -29},
+                                 {-15, 16, -22, -24, -3, 16, -6, -10},
+                                 {19, -8, -13, 11, -5, 30, 9, 9},
+                                 {-27, 12, -4, 14, 4, 28, 9, -17},
+                                 {11, 19, 28, -26, 6, -14, 4, 8}});
+  const long long kKnownDet = 9671745052;
+  assert(known.det() == kKnownDet);
+  assert(DynamicMatrix<long long>(known).det() == kKnownDet);
+  assert(my::bareiss_det(known, my::par) == kKnownDet);
+  assert(my::crt_det<__int128>(known) == kKnownDet);
+  assert(known.rank() == 8);
+
+  std::mt19937 gen(49);
+  std::uniform_int_distribution<int> value(-30, 30);
+  for (size_t test = 0; test < 40; ++test) {
+    DynamicMatrix<long long> matrix(8, 8);
+    for (size_t i = 0; i < 8; ++i) {
+      for (size_t j = 0; j < 8; ++j) {
+        matrix[i][j] = value(gen);
+      }
+    }
+    __int128 expected = my::crt_det<__int128>(matrix);
+    assert(matrix.det() == expected);
+    assert(my::bareiss_det(matrix) == expected);
+    DynamicMatrix<__int128> wide(8, 8);
+    for (size_t i = 0; i < 8; ++i) {
+      for (size_t j = 0; j < 8; ++j) {
+        wide[i][j] = matrix[i][j];
+      }
+    }
+    assert(my::bareiss_det(wide) == expected);
+  }
+
+  // crt_det<long long>: произведение простых больше 2^62, но в long long
+  // собирается только сам определитель
+  assert(my::crt_det<long long>(known) == kKnownDet);
+  std::uniform_int_distribution<int> wide_value(-10000, 10000);
+  for (size_t test = 0; test < 200; ++test) {
+    Matrix<4, 4, long long> matrix;
+    for (size_t i = 0; i < 4; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        matrix[i][j] = wide_value(gen);
+      }
+    }
+    long long expected = matrix.det();
+    assert(my::crt_det<long long>(matrix) == expected);
+    assert(my::crt_det<__int128>(matrix) == expected);
+    matrix[3] = matrix[0];
+    assert(my::crt_det<long long>(matrix) == 0);
+  }
+
+  // миноры 20 x 20 с элементами до 1000 не помещаются в long long:
+  // ошибка, а не неверный определитель
+  DynamicMatrix<long long> big(20, 20);
+  std::uniform_int_distribution<int> large(-1000, 1000);
+  for (size_t i = 0; i < 20; ++i) {
+    for (size_t j = 0; j < 20; ++j) {
+      big[i][j] = large(gen);
+    }
+  }
+  bool thrown = false;
+  try {
+    big.det(my::par);
+  } catch (const std::overflow_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+// Произведение по определению, без gemm.
+template <typename Field>
+DynamicMatrix<Field> naive_product(const DynamicMatrix<Field>& first,
+                                   const DynamicMatrix<Field>& second) {
+  DynamicMatrix<Field> ans(first.rows(), second.cols());
+  for (size_t i = 0; i < first.rows(); ++i) {
+    for (size_t j = 0; j < second.cols(); ++j) {
+      Field sum(0);
+      for (size_t k = 0; k < first.cols(); ++k) {
+        sum += first[i][k] * second[k][j];
+      }
+      ans[i][j] = sum;
+    }
+  }
+  return ans;
+}
+
+void TestStrassen() {
+  std::mt19937 gen(44);
+  // нечётные и разные размеры: хвосты по каждой из трёх сторон на каждом
+  // уровне рекурсии; малый cutoff даёт несколько уровней
+  struct {
+    size_t n, k, m;
+  } sizes[] = {{1, 1, 1},    {2, 2, 2},     {3, 5, 7},   {7, 9, 5},
+               {16, 16, 16}, {33, 17, 65},  {64, 1, 64}, {101, 99, 103},
+               {130, 70, 3}, {127, 129, 128}};
+  for (const auto& size : sizes) {
+    DynamicMatrix<Mod> first = random_matrix<Mod>(size.n, size.k, gen);
+    DynamicMatrix<Mod> second = random_matrix<Mod>(size.k, size.m, gen);
+    DynamicMatrix<Mod> expected = naive_product(first, second);
+    for (size_t cutoff : {size_t(0), size_t(1), size_t(2), size_t(5),
+                          size_t(16), my::kStrassenCutoff}) {
+      assert(my::strassen_multiply(my::seq, first, second, cutoff) ==
+             expected);
+    }
+    assert(my::strassen_multiply(my::par, first, second, 4) == expected);
+  }
+
+  // Matrix фиксированного размера
+  Matrix<7, 9, Mod> first;
+  Matrix<9, 5, Mod> second;
+  for (size_t i = 0; i < 9; ++i) {
+    for (size_t j = 0; j < 9; ++j) {
+      if (i < 7) {
+        first[i][j] = Mod(int(i * 31 + j * 17 + 3));
+      }
+      if (j < 5) {
+        second[i][j] = Mod(int(i * 13 + j * 7 + 1));
+      }
+    }
+  }
+  assert(my::strassen_multiply(my::seq, first, second, 1) == first * second);
+
+  // double: та же величина с погрешностью
+  DynamicMatrix<double> a = random_matrix<double>(65, 47, gen);
+  DynamicMatrix<double> b = random_matrix<double>(47, 81, gen);
+  DynamicMatrix<double> exact = naive_product(a, b);
+  DynamicMatrix<double> fast = my::strassen_multiply(my::seq, a, b, 2);
+  for (size_t i = 0; i < exact.rows(); ++i) {
+    for (size_t j = 0; j < exact.cols(); ++j) {
+      assert(std::abs(fast[i][j] - exact[i][j]) <= 1e-9 * 47 * 1e6);
+    }
+  }
+
+  bool thrown = false;
+  try {
+    my::strassen_multiply(my::seq, a, a);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+// a[n] по рекуррентности, по одному члену
+std::vector<Mod> iterate(const std::vector<Mod>& coefs,
+                         std::vector<Mod> terms, size_t count) {
+  while (terms.size() < count) {
+    Mod next(0);
+    for (size_t i = 0; i < coefs.size(); ++i) {
+      next += coefs[i] * terms[terms.size() - 1 - i];
+    }
+    terms.push_back(next);
+  }
+  return terms;
+}
+
+void TestRecurrence() {
+  std::mt19937 gen(45);
+  // pow против повторного умножения и сложения степеней
+  DynamicMatrix<Mod> matrix = random_matrix<Mod>(5, 5, gen);
+  DynamicMatrix<Mod> power = DynamicMatrix<Mod>::unityMatrix(5);
+  for (uint64_t k = 0; k <= 20; ++k) {
+    assert(my::pow(matrix, k) == power);
+    power = power * matrix;
+  }
+  uint64_t big = 1'000'000'000'000'000'003;
+  assert(my::pow(matrix, big, my::par) ==
+         my::pow(matrix, big / 2) * my::pow(matrix, big - big / 2));
+  assert(my::pow(DynamicMatrix<Mod>(0, 0), 5).rows() == 0);
+  bool thrown = false;
+  try {
+    my::pow(DynamicMatrix<Mod>(2, 3), 2);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // Фибоначчи: [[1, 1], [1, 0]]^n = [[F(n+1), F(n)], [F(n), F(n-1)]]
+  Matrix<2, 2, Mod> fibonacci_matrix({{1, 1}, {1, 0}});
+  LinearRecurrence<Mod> fibonacci({Mod(1), Mod(1)}, {Mod(0), Mod(1)});
+  std::vector<Mod> fibonacci_terms =
+      iterate({Mod(1), Mod(1)}, {Mod(0), Mod(1)}, 100);
+  for (uint64_t n = 0; n < 100; ++n) {
+    assert(fibonacci.nth(n) == fibonacci_terms[n]);
+  }
+  for (uint64_t n : {uint64_t(1), uint64_t(64), big}) {
+    assert(fibonacci.nth(n) == my::pow(fibonacci_matrix, n)[0][1]);
+  }
+  assert(my::pow(fibonacci_matrix, 0) == (Matrix<2, 2, Mod>::unityMatrix()));
+
+  // порядок 1 и 0
+  LinearRecurrence<Mod> geometric({Mod(3)}, {Mod(2)});
+  assert(geometric.nth(0) == Mod(2) && geometric.nth(5) == Mod(486));
+  assert(LinearRecurrence<Mod>({}, {}).nth(7) == Mod(0));
+  thrown = false;
+  try {
+    LinearRecurrence<Mod>({Mod(1), Mod(1)}, {Mod(1)});
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // порядок 6: nth против перебора и степени сопровождающей матрицы,
+  // fromTerms по 2d членам восстанавливает ту же рекуррентность
+  const size_t kOrder = 6;
+  std::uniform_int_distribution<int> value(0, 1000);
+  std::vector<Mod> coefs(kOrder);
+  std::vector<Mod> initial(kOrder);
+  for (size_t i = 0; i < kOrder; ++i) {
+    coefs[i] = Mod(value(gen));
+    initial[i] = Mod(value(gen));
+  }
+  coefs.back() = Mod(value(gen) + 1);
+  LinearRecurrence<Mod> recurrence(coefs, initial);
+  std::vector<Mod> terms = iterate(coefs, initial, 300);
+  for (uint64_t n = 0; n < terms.size(); ++n) {
+    assert(recurrence.nth(n) == terms[n]);
+  }
+  // состояние (a[n + d - 1], ..., a[n]): первая строка - коэффициенты
+  DynamicMatrix<Mod> companion(kOrder, kOrder);
+  for (size_t j = 0; j < kOrder; ++j) {
+    companion[0][j] = coefs[j];
+  }
+  for (size_t i = 1; i < kOrder; ++i) {
+    companion[i][i - 1] = Mod(1);
+  }
+  DynamicMatrix<Mod> shifted = my::pow(companion, big);
+  Mod expected(0);
+  for (size_t j = 0; j < kOrder; ++j) {
+    expected += shifted[kOrder - 1][j] * initial[kOrder - 1 - j];
+  }
+  assert(recurrence.nth(big) == expected);
+
+  LinearRecurrence<Mod> found = LinearRecurrence<Mod>::fromTerms(
+      std::vector<Mod>(terms.begin(), terms.begin() + 2 * kOrder));
+  assert(found.order() == kOrder && found.coefficients() == coefs);
+  assert(found.nth(big) == expected);
+
+  // fromTerms: Фибоначчи по первым членам, нули и геометрическая
+  LinearRecurrence<Mod> recovered = LinearRecurrence<Mod>::fromTerms(
+      std::vector<Mod>(fibonacci_terms.begin(), fibonacci_terms.begin() + 10));
+  assert(recovered.order() == 2 && recovered.nth(99) == fibonacci_terms[99]);
+  assert(LinearRecurrence<Mod>::fromTerms(std::vector<Mod>(8, Mod(0)))
+             .order() == 0);
+  LinearRecurrence<Mod> powers = LinearRecurrence<Mod>::fromTerms(
+      {Mod(2), Mod(6), Mod(18), Mod(54)});
+  assert(powers.order() == 1 && powers.nth(5) == Mod(486));
+}
+
+template <size_t N, size_t M>
+Matrix<N, M, Mod> random_fixed(std::mt19937& gen) {
+  DynamicMatrix<Mod> values = random_matrix<Mod>(N, M, gen);
+  Matrix<N, M, Mod> matrix;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < M; ++j) {
+      matrix[i][j] = values[i][j];
+    }
+  }
+  return matrix;
+}
+
+void TestExpressions() {
+  std::mt19937 gen(46);
+  auto first = random_fixed<3, 4>(gen);
+  auto second = random_fixed<3, 4>(gen);
+  auto third = random_fixed<3, 4>(gen);
+  auto other = random_fixed<4, 3>(gen);
+  const Mod k(7);
+
+  Matrix<3, 4, Mod> expected;
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      expected[i][j] = first[i][j] + second[i][j] * k;
+    }
+  }
+  // A = A + B * k на месте: каждая клетка читает только себя
+  auto aliased = first;
+  aliased = aliased + second * k;
+  assert(aliased == expected);
+  aliased = first;
+  aliased = k * second + aliased;
+  assert(aliased == expected);
+  aliased = first;
+  aliased = aliased - third + aliased * Mod(2);
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      assert(aliased[i][j] == first[i][j] * Mod(3) - third[i][j]);
+    }
+  }
+
+  // временное A * B хранится в выражении по значению и переживает
+  // полное выражение, в котором создано
+  Matrix<3, 3, Mod> square = random_fixed<3, 3>(gen);
+  auto held = first * other - square;
+  auto product = first * other;
+  Matrix<3, 3, Mod> unrelated = first * other * Mod(5);
+  Matrix<3, 3, Mod> value = held;
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      assert(value[i][j] == product[i][j] - square[i][j]);
+    }
+  }
+  assert(unrelated != value);
+  // lvalue-лист - ссылка: изменения square видны в held
+  square[0][0] += Mod(1);
+  assert(held.at(0, 0) == product[0][0] - square[0][0]);
+
+  // == и != с выражением с обеих сторон, без вычисления в матрицу
+  assert(first + second * k == expected);
+  assert(expected == first + second * k);
+  assert(first + second * k == second * k + first);
+  assert(!(first + second * k != expected));
+  expected[2][3] += Mod(1);
+  assert(first + second * k != expected);
+  assert(expected != first + second * k);
+
+  // произведение с выражением-множителем и eval
+  assert((first + second) * other == first * other + second * other);
+  assert((first - first).eval() == (Matrix<3, 4, Mod>()));
+}
+
+// Произведения по видам: транспонированные операнды и результат,
+// подматрицы с чужим шагом строки.
+template <typename Field, typename Policy>
+void CheckViewProducts(const Policy& policy, size_t n, size_t k, size_t m,
+                       std::mt19937& gen) {
+  DynamicMatrix<Field> first = random_matrix<Field>(n, k, gen);
+  DynamicMatrix<Field> second = random_matrix<Field>(k, m, gen);
+  DynamicMatrix<Field> expected = naive_product(first, second);
+
+  DynamicMatrix<Field> ans(n, m);
+  my::gemm(policy, first.view(), second.view(), ans.view());
+  assert(ans == expected);
+
+  DynamicMatrix<Field> first_t(first.view().transposed());
+  DynamicMatrix<Field> second_t(second.view().transposed());
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      assert(first_t[j][i] == first[i][j]);
+    }
+  }
+  DynamicMatrix<Field> from_transposed(n, m);
+  my::gemm(policy, first_t.view().transposed(), second_t.view().transposed(),
+           from_transposed.view());
+  assert(from_transposed == expected);
+  // (A B)^T = B^T A^T прямо в транспонированный вид результата
+  DynamicMatrix<Field> into_transposed(n, m);
+  my::gemm(policy, second.view().transposed(), first.view().transposed(),
+           into_transposed.view().transposed());
+  assert(into_transposed == expected);
+
+  DynamicMatrix<Field> outer_first = random_matrix<Field>(n + 3, k + 4, gen);
+  DynamicMatrix<Field> outer_second = random_matrix<Field>(k + 5, m + 2, gen);
+  DynamicMatrix<Field> target = random_matrix<Field>(n + 6, m + 6, gen);
+  DynamicMatrix<Field> before(target.view());
+  DynamicMatrix<Field> subtracted(target.view());
+  auto first_block = outer_first.view().block(1, 2, n, k);
+  auto second_block = outer_second.view().block(3, 1, k, m);
+  DynamicMatrix<Field> block_product = naive_product(
+      DynamicMatrix<Field>(first_block), DynamicMatrix<Field>(second_block));
+  my::gemm(policy, first_block, second_block, target.view().block(2, 4, n, m));
+  my::gemm_subtract(policy, first_block, second_block,
+                    subtracted.view().block(2, 4, n, m));
+  for (size_t i = 0; i < n + 6; ++i) {
+    for (size_t j = 0; j < m + 6; ++j) {
+      if (i >= 2 && i < n + 2 && j >= 4 && j < m + 4) {
+        assert(target[i][j] == block_product[i - 2][j - 4]);
+        assert(subtracted[i][j] + block_product[i - 2][j - 4] ==
+               before[i][j]);
+      } else {
+        assert(target[i][j] == before[i][j]);
+        assert(subtracted[i][j] == before[i][j]);
+      }
+    }
+  }
+}
+
+void TestViews() {
+  std::mt19937 gen(48);
+  // меньше kPackedGemmThreshold - простой цикл, от него - упакованный
+  CheckViewProducts<Mod>(my::seq, 7, 9, 5, gen);
+  CheckViewProducts<Mod>(my::par, 13, 1, 11, gen);
+  CheckViewProducts<Mod>(my::par, 35, 33, 37, gen);
+  CheckViewProducts<double>(my::seq, 6, 5, 7, gen);
+  CheckViewProducts<double>(my::seq, 37, 41, 43, gen);
+  CheckViewProducts<double>(my::par, 67, 35, 33, gen);
+
+  DynamicMatrix<Mod> matrix = random_matrix<Mod>(4, 6, gen);
+  DynamicMatrix<Mod> ans(4, 4);
+  bool thrown = false;
+  try {
+    my::gemm(my::seq, matrix.view(), matrix.view(), ans.view());
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+  thrown = false;
+  try {
+    matrix.view().block(1, 3, 3, 4);
+  } catch (const std::out_of_range&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // вид фиксированной матрицы: строки, столбцы, след транспонированной
+  auto fixed = random_fixed<3, 3>(gen);
+  Mod trace = fixed[0][0] + fixed[1][1] + fixed[2][2];
+  assert(fixed.transposedView().trace() == trace);
+  assert(fixed.transposedView().row(1)[2] == fixed[2][1]);
+  assert(fixed.column(2)[1] == fixed[1][2]);
+}
+
+// gemm для float и double на размерах, не кратных плитке kRows x kCols
+// и блокам, с шагами строк больше ширины. Целые значения до 8 по модулю
+// дают точные суммы в обоих типах, так что сравнение точное.
+template <typename T, typename Policy>
+void CheckFloatGemm(const Policy& policy, size_t n, size_t k, size_t m,
+                    std::mt19937& gen) {
+  std::uniform_int_distribution<int> value(-8, 8);
+  size_t lda = k + 3;
+  size_t ldb = m + 5;
+  size_t ldc = m + 2;
+  const T kPadding = 42;
+  std::vector<T> a(n * lda);
+  std::vector<T> b(k * ldb);
+  std::vector<T> c(n * ldc, kPadding);
+  std::vector<T> subtracted(n * ldc, kPadding);
+  for (auto& elem : a) {
+    elem = T(value(gen));
+  }
+  for (auto& elem : b) {
+    elem = T(value(gen));
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      subtracted[i * ldc + j] = T(value(gen));
+    }
+  }
+  std::vector<T> before = subtracted;
+
+  my::gemm(policy, n, k, m, a.data(), lda, b.data(), ldb, c.data(), ldc);
+  my::gemm_subtract(policy, n, k, m, a.data(), lda, b.data(), ldb,
+                    subtracted.data(), ldc);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < ldc; ++j) {
+      if (j >= m) {
+        assert(c[i * ldc + j] == kPadding);
+        assert(subtracted[i * ldc + j] == kPadding);
+        continue;
+      }
+      T sum = 0;
+      for (size_t p = 0; p < k; ++p) {
+        sum += a[i * lda + p] * b[p * ldb + j];
+      }
+      assert(c[i * ldc + j] == sum);
+      assert(subtracted[i * ldc + j] == before[i * ldc + j] - sum);
+    }
+  }
+}
+
+void TestFloatGemm() {
+  std::mt19937 gen(38);
+  // kRows = 6, kCols = 8 (double) и 16 (float) при AVX2; блоки 96 строк,
+  // 256 по глубине и 2048 столбцов
+  const size_t kSizes[][3] = {{1, 1, 1},    {5, 7, 3},     {7, 9, 17},
+                              {37, 41, 43}, {97, 257, 33}, {13, 35, 2049}};
+  for (const auto& size : kSizes) {
+    CheckFloatGemm<double>(my::seq, size[0], size[1], size[2], gen);
+    CheckFloatGemm<float>(my::seq, size[0], size[1], size[2], gen);
+    CheckFloatGemm<double>(my::par, size[0], size[1], size[2], gen);
+    CheckFloatGemm<float>(my::par, size[0], size[1], size[2], gen);
+  }
+
+  // нецелые значения: погрешность в пределах суммы модулей слагаемых
+  const size_t n = 67;
+  const size_t k = 259;
+  const size_t m = 45;
+  std::uniform_real_distribution<double> real(-1, 1);
+  std::vector<double> a(n * k);
+  std::vector<double> b(k * m);
+  std::vector<double> c(n * m);
+  for (auto& elem : a) {
+    elem = real(gen);
+  }
+  for (auto& elem : b) {
+    elem = real(gen);
+  }
+  my::gemm(my::par, n, k, m, a.data(), k, b.data(), m, c.data(), m);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      double sum = 0;
+      double bound = 0;
+      for (size_t p = 0; p < k; ++p) {
+        sum += a[i * k + p] * b[p * m + j];
+        bound += std::abs(a[i * k + p] * b[p * m + j]);
+      }
+      assert(std::abs(c[i * m + j] - sum) <= 1e-14 * k * bound);
+    }
+  }
+}
+
+// Арифметика Residue<N> против 64-битной: крайние и случайные значения.
+template <size_t N>
+void CheckResidue(std::mt19937& gen) {
+  using R = Residue<N>;
+  const int64_t n = N;
+  std::uniform_int_distribution<int64_t> random(0, n - 1);
+  std::vector<int64_t> values = {0, 1, 2, n / 2, n - 2, n - 1};
+  for (int i = 0; i < 200; ++i) {
+    values.push_back(random(gen));
+  }
+  for (int64_t first : values) {
+    for (int64_t second : values) {
+      R lhs(static_cast<int>(first));
+      R rhs(static_cast<int>(second));
+      assert((lhs + rhs).value == (first + second) % n);
+      assert((lhs - rhs).value == (first - second + n) % n);
+      assert((lhs * rhs).value == first * second % n);
+    }
+  }
+
+  // конструктор от отрицательных и крайних int
+  for (int64_t value : {int64_t(-1), int64_t(-n + 1),
+                        int64_t(std::numeric_limits<int>::min()),
+                        int64_t(std::numeric_limits<int>::max())}) {
+    assert(R(static_cast<int>(value)).value == (value % n + n) % n);
+  }
+}
+
+template <size_t N>
+void CheckInverse(std::mt19937& gen) {
+  using R = Residue<N>;
+  std::uniform_int_distribution<int> random(1, static_cast<int>(N - 1));
+  std::vector<int> values = {1, 2, static_cast<int>(N - 2),
+                             static_cast<int>(N - 1)};
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(random(gen));
+  }
+  for (int value : values) {
+    R elem(value);
+    assert(elem * (R(1) / elem) == R(1));
+    assert(R(1) / (R(1) / elem) == elem);
+  }
+  assert((R(1) / R(static_cast<int>(N - 1))).value == static_cast<int>(N - 1));
+  // обратного к нулю нет: 0, как и раньше
+  assert((R(5) / R(0)).value == 0);
+}
+
+void TestResidue() {
+  std::mt19937 gen(41);
+  // 2^31 - 1 и 2^31: суммы до 2^32 - 2, произведения до 2^62; 65521 и
+  // 65537 - по обе стороны от 32-битного умножения при N < 2^16
+  CheckResidue<2147483647>(gen);
+  CheckResidue<2147483648>(gen);
+  CheckResidue<2147483629>(gen);
+  CheckResidue<1000000007>(gen);
+  CheckResidue<65521>(gen);
+  CheckResidue<65537>(gen);
+  CheckResidue<2>(gen);
+  CheckResidue<1>(gen);
+
+  CheckInverse<2147483647>(gen);
+  CheckInverse<2147483629>(gen);
+  CheckInverse<1000000007>(gen);
+  CheckInverse<65521>(gen);
+  CheckInverse<65537>(gen);
+  CheckInverse<3>(gen);
+
+  // составной модуль: обратный только у взаимно простых
+  assert(my::detail::modular_inverse<1000>(3) == 667);
+  assert(my::detail::modular_inverse<1000>(10) == 0);
+  assert(my::detail::modular_inverse<2147483648>(2147483647) == 2147483647);
+}
+
+// Порядок g по модулю простого p перебором: g - первообразный корень,
+// если порядок p - 1.
+bool is_primitive_root(uint64_t g, uint64_t p) {
+  uint64_t power = g % p;
+  for (uint64_t order = 1; order < p - 1; ++order) {
+    if (power == 1) {
+      return false;
+    }
+    power = power * g % p;
+  }
+  return power == 1;
+}
+
+template <uint64_t N>
+void CheckMontgomery() {
+  using traits = my::modulus_traits<N>;
+  static_assert(traits::montgomery);
+  // N * (-N^-1) = -1 по модулю 2^32, R^2 mod N
+  static_assert(uint32_t(N * traits::montgomery_inverse) == UINT32_MAX);
+  static_assert(traits::montgomery_r2 ==
+                ((unsigned __int128)1 << 64) % N);
+}
+
+void TestModulusTraits() {
+  // простота перебором делителей на малых n
+  for (uint64_t n = 0; n < 5000; ++n) {
+    bool prime = n >= 2;
+    for (uint64_t d = 2; d * d <= n && prime; ++d) {
+      prime = n % d != 0;
+    }
+    assert(my::is_prime_number(n) == prime);
+  }
+  // 64-битные простые и сильные псевдопростые по малым основаниям
+  for (uint64_t prime : {4294967291ull, 2305843009213693951ull,
+                         18446744073709551557ull}) {
+    assert(my::is_prime_number(prime));
+  }
+  for (uint64_t composite :
+       {561ull, 3215031751ull, 341550071728321ull, 3825123056546413051ull,
+        4294967291ull * 4294967291ull, 18446744073709551615ull}) {
+    assert(!my::is_prime_number(composite));
+  }
+
+  // наименьший первообразный корень на малых простых
+  for (uint64_t p = 3; p < 2000; ++p) {
+    if (!my::is_prime_number(p)) {
+      continue;
+    }
+    uint64_t root = my::detail::primitive_root(p);
+    assert(is_primitive_root(root, p));
+    for (uint64_t g = 2; g < root; ++g) {
+      assert(!is_primitive_root(g, p));
+    }
+  }
+
+  static_assert(my::modulus_traits<998244353>::primitive_root == 3);
+  static_assert(my::modulus_traits<1000000007>::primitive_root == 5);
+  static_assert(my::modulus_traits<2147483647>::primitive_root == 7);
+  static_assert(my::modulus_traits<65537>::primitive_root == 3);
+  static_assert(my::modulus_traits<2>::primitive_root == 1);
+  // не простое и не считавшийся при N >= 2^32
+  static_assert(my::modulus_traits<1000000008>::primitive_root == 0);
+  static_assert(my::modulus_traits<4294967311>::is_prime);
+  static_assert(my::modulus_traits<4294967311>::primitive_root == 0);
+
+  static_assert(my::modulus_traits<1>::bits == 1);
+  static_assert(my::modulus_traits<65535>::bits == 16);
+  static_assert(my::modulus_traits<65536>::bits == 17);
+  static_assert(my::modulus_traits<2147483648>::bits == 32);
+  static_assert(my::modulus_traits<18446744073709551557ull>::bits == 64);
+  static_assert(my::modulus_traits<18446744073709551557ull>::is_prime);
+  static_assert(!my::modulus_traits<1>::is_prime);
+
+  CheckMontgomery<3>();
+  CheckMontgomery<1000000007>();
+  CheckMontgomery<2147483647>();
+  CheckMontgomery<4294967291>();
+  CheckMontgomery<4294967295>();
+  static_assert(!my::modulus_traits<2147483648>::montgomery);
+  static_assert(!my::modulus_traits<4294967297>::montgomery);
+  static_assert(my::modulus_traits<4294967297>::montgomery_inverse == 0);
+}
+
+int main() {
+  std::cerr << "Starting tests" << std::endl;
+  TestLU();
+  std::cerr << "TestLU passed" << std::endl;
+  TestSingular();
+  std::cerr << "TestSingular passed" << std::endl;
+  TestWiedemann();
+  std::cerr << "TestWiedemann passed" << std::endl;
+  TestExactDeterminant();
+  std::cerr << "TestExactDeterminant passed" << std::endl;
+  TestStrassen();
+  std::cerr << "TestStrassen passed" << std::endl;
+  TestRecurrence();
+  std::cerr << "TestRecurrence passed" << std::endl;
+  TestExpressions();
+  std::cerr << "TestExpressions passed" << std::endl;
+  TestViews();
+  std::cerr << "TestViews passed" << std::endl;
+  TestFloatGemm();
+  std::cerr << "TestFloatGemm passed" << std::endl;
+  TestResidue();
+  std::cerr << "TestResidue passed" << std::endl;
+  TestModulusTraits();
+  std::cerr << "TestModulusTraits passed" << std::endl;
+  std::cout << 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+
+// Свойства модуля, посчитанные при компиляции constexpr-функциями, а не
+// рекурсией шаблонов: проверка простоты, первообразный корень, константы
+// Монтгомери и разрядность.
+namespace my {
+namespace detail {
+constexpr uint64_t mul_mod(uint64_t first, uint64_t second, uint64_t mod) {
+  return static_cast<uint64_t>((unsigned __int128)first * second % mod);
+}
+
+constexpr uint64_t pow_mod(uint64_t base, uint64_t power, uint64_t mod) {
+  uint64_t ans = 1 % mod;
+  for (base %= mod; power != 0; power >>= 1) {
+    if (power & 1) {
+      ans = mul_mod(ans, base, mod);
+    }
+    base = mul_mod(base, base, mod);
+  }
+  return ans;
+}
+
+// n - 1 = d * 2^shift, d нечётно
+constexpr bool miller_rabin_passes(uint64_t n, uint64_t base, uint64_t d,
+                                   int shift) {
+  uint64_t cnt = pow_mod(base, d, n);
+  if (cnt == 0 || cnt == 1 || cnt == n - 1) {
+    return true;
+  }
+  for (int i = 1; i < shift; ++i) {
+    cnt = mul_mod(cnt, cnt, n);
+    if (cnt == n - 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Наименьший первообразный корень простого p: g, для которого
+// g^((p - 1) / q) != 1 при всех простых q | p - 1. Делители p - 1
+// ищутся перебором до корня, поэтому считается только при p < 2^32.
+constexpr uint64_t primitive_root(uint64_t p) {
+  if (p == 2) {
+    return 1;
+  }
+
+  uint64_t factors[64] = {};
+  int count = 0;
+  uint64_t rest = p - 1;
+  for (uint64_t q = 2; q * q <= rest; ++q) {
+    if (rest % q == 0) {
+      factors[count++] = q;
+      while (rest % q == 0) {
+        rest /= q;
+      }
+    }
+  }
+  if (rest > 1) {
+    factors[count++] = rest;
+  }
+
+  for (uint64_t g = 2;; ++g) {
+    bool root = true;
+    for (int i = 0; i < count && root; ++i) {
+      root = pow_mod(g, (p - 1) / factors[i], p) != 1;
+    }
+    if (root) {
+      return g;
+    }
+  }
+}
+
+// -N^-1 по модулю 2^32 итерациями Ньютона: каждая удваивает число верных
+// бит, начиная с трёх (N * N = 1 по модулю 8 для нечётного N).
+constexpr uint32_t montgomery_inverse(uint32_t n) {
+  uint32_t inverse = n;
+  for (int i = 0; i < 4; ++i) {
+    inverse *= 2 - n * inverse;
+  }
+  return -inverse;
+}
+}  // namespace detail
+
+// Детерминированный тест Миллера - Рабина: этих семи оснований хватает
+// для всех 64-битных чисел.
+constexpr bool is_prime_number(uint64_t n) {
+  if (n < 2) {
+    return false;
+  }
+  for (uint64_t p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+    if (n % p == 0) {
+      return n == p;
+    }
+  }
+
+  uint64_t d = n - 1;
+  int shift = 0;
+  for (; d % 2 == 0; d /= 2) {
+    ++shift;
+  }
+  for (uint64_t base : {2, 325, 9375, 28178, 450775, 9780504, 1795265022}) {
+    if (!detail::miller_rabin_passes(n, base, d, shift)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <uint64_t N>
+struct modulus_traits {
+  static_assert(N >= 1);
+
+  static constexpr uint64_t modulus = N;
+  static constexpr bool is_prime = is_prime_number(N);
+  // бит в записи N
+  static constexpr int bits = std::bit_width(N);
+
+  // 0, если корень не определён (N не простое) или не считался (N >= 2^32)
+  static constexpr uint64_t primitive_root =
+      is_prime && N < (uint64_t(1) << 32) ? detail::primitive_root(N) : 0;
+
+  // Монтгомери с R = 2^32: для нечётных N < 2^32. montgomery_inverse =
+  // -N^-1 mod R, montgomery_r2 = R^2 mod N переводит число в форму
+  // Монтгомери одним умножением.
+  static constexpr bool montgomery = N % 2 == 1 && N < (uint64_t(1) << 32);
+  static constexpr uint32_t montgomery_inverse =
+      montgomery ? detail::montgomery_inverse(N) : 0;
+  static constexpr uint32_t montgomery_r2 =
+      montgomery ? detail::pow_mod(2, 64, N) : 0;
+};
+}  // namespace my
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "dynamic_matrix.h"
+#include "gemm.h"
+#include "matrix.h"
+
+// Степени матриц и n-й член линейной рекуррентности.
+//
+// pow - бинарное возведение в два буфера: результат и его квадрат
+// (произведение) пишутся попеременно то в один, то в другой, без копий
+// матрицы на каждом шаге. LinearRecurrence считает n-й член методом
+// Китамасы за O(d^2 log n) вместо O(d^3 log n) у степени сопровождающей
+// матрицы.
+namespace my {
+namespace detail {
+// dst = src^power для n x n; power > 0
+template <typename Policy, typename Field>
+void matrix_pow(const Policy& policy, const Field* src, size_t src_stride,
+                size_t n, uint64_t power, Field* dst, size_t dst_stride) {
+  std::vector<Field> current(n * n);
+  std::vector<Field> next(n * n);
+  for (size_t i = 0; i < n; ++i) {
+    std::copy(src + i * src_stride, src + i * src_stride + n,
+              current.begin() + i * n);
+  }
+
+  // слева направо по битам: старший бит уже учтён копией src
+  int bit = 63;
+  while ((power >> bit & 1) == 0) {
+    --bit;
+  }
+  for (--bit; bit >= 0; --bit) {
+    gemm(policy, n, n, n, current.data(), n, current.data(), n, next.data(),
+         n);
+    std::swap(current, next);
+    if (power >> bit & 1) {
+      gemm(policy, n, n, n, current.data(), n, src, src_stride, next.data(),
+           n);
+      std::swap(current, next);
+    }
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    std::copy(current.begin() + i * n, current.begin() + (i + 1) * n,
+              dst + i * dst_stride);
+  }
+}
+
+// first * second по модулю x^d - coefs[0] x^(d-1) - ... - coefs[d-1];
+// многочлены степени меньше d, коэффициенты от младшего
+template <typename Field>
+std::vector<Field> poly_mul_mod(const std::vector<Field>& first,
+                                const std::vector<Field>& second,
+                                const std::vector<Field>& coefs) {
+  size_t d = coefs.size();
+  std::vector<Field> product(2 * d - 1, Field(0));
+  for (size_t i = 0; i < d; ++i) {
+    for (size_t j = 0; j < d; ++j) {
+      product[i + j] += first[i] * second[j];
+    }
+  }
+
+  // x^d = sum coefs[i] x^(d-1-i): старшие степени сносятся вниз
+  for (size_t i = 2 * d - 1; i-- > d;) {
+    const Field& top = product[i];
+    for (size_t j = 0; j < d; ++j) {
+      product[i - 1 - j] += top * coefs[j];
+    }
+  }
+  product.resize(d);
+  return product;
+}
+}  // namespace detail
+
+template <typename Policy = sequenced_policy, size_t N, typename Field>
+Matrix<N, N, Field> pow(const Matrix<N, N, Field>& matrix, uint64_t power,
+                        const Policy& policy = seq) {
+  if (power == 0 || N == 0) {
+    return Matrix<N, N, Field>::unityMatrix();
+  }
+
+  Matrix<N, N, Field> ans;
+  detail::matrix_pow(policy, matrix[0].data(), N, N, power, ans[0].data(),
+                     N);
+  return ans;
+}
+
+template <typename Policy = sequenced_policy, typename Field>
+DynamicMatrix<Field> pow(const DynamicMatrix<Field>& matrix, uint64_t power,
+                         const Policy& policy = seq) {
+  if (matrix.rows() != matrix.cols()) {
+    throw std::invalid_argument("pow: matrix not square");
+  }
+  if (power == 0 || matrix.rows() == 0) {
+    return DynamicMatrix<Field>::unityMatrix(matrix.rows());
+  }
+
+  DynamicMatrix<Field> ans(matrix.rows(), matrix.cols());
+  detail::matrix_pow(policy, matrix.data(), matrix.stride(), matrix.rows(),
+                     power, ans.data(), ans.stride());
+  return ans;
+}
+}  // namespace my
+
+// a[n] = coefs[0] a[n - 1] + ... + coefs[d - 1] a[n - d] с начальными
+// a[0..d-1]. nth(n) - метод Китамасы: x^n по модулю характеристического
+// многочлена даёт a[n] как комбинацию начальных членов.
+template <typename Field = Rational>
+class LinearRecurrence {
+ private:
+  std::vector<Field> coefs_;
+  std::vector<Field> initial_;
+
+ public:
+  LinearRecurrence(std::vector<Field> coefs, std::vector<Field> initial)
+      : coefs_(std::move(coefs)), initial_(std::move(initial)) {
+    if (initial_.size() < coefs_.size()) {
+      throw std::invalid_argument("LinearRecurrence: too few initial terms");
+    }
+    initial_.resize(coefs_.size());
+  }
+
+  // Кратчайшая рекуррентность, порождающая terms (Берлекэмп - Месси).
+  // Однозначна, если terms содержит хотя бы вдвое больше членов, чем её
+  // порядок.
+  static LinearRecurrence fromTerms(const std::vector<Field>& terms) {
+    const Field zero(0);
+    size_t count = terms.size();
+    std::vector<Field> current(count, zero);
+    std::vector<Field> previous(count, zero);
+    Field previous_delta(1);
+    size_t length = 0;
+    size_t shift = 1;
+
+    for (size_t n = 0; n < count; ++n) {
+      Field delta = terms[n];
+      for (size_t i = 0; i < length; ++i) {
+        delta -= current[i] * terms[n - 1 - i];
+      }
+      if (delta == zero) {
+        ++shift;
+        continue;
+      }
+
+      // C(x) -= delta / previous_delta * x^shift * B(x), где
+      // C(x) = 1 - sum current[i] x^(i+1), B - то же для previous
+      bool longer = 2 * length <= n;
+      std::vector<Field> saved = longer ? current : std::vector<Field>();
+      Field koef = delta / previous_delta;
+      current[shift - 1] += koef;
+      for (size_t i = 0; shift + i < count; ++i) {
+        current[shift + i] -= koef * previous[i];
+      }
+
+      if (longer) {
+        length = n + 1 - length;
+        previous = std::move(saved);
+        previous_delta = delta;
+        shift = 1;
+      } else {
+        ++shift;
+      }
+    }
+
+    current.resize(length);
+    std::vector<Field> initial(terms.begin(), terms.begin() + length);
+    return LinearRecurrence(std::move(current), std::move(initial));
+  }
+
+  size_t order() const {
+    return coefs_.size();
+  }
+
+  const std::vector<Field>& coefficients() const {
+    return coefs_;
+  }
+
+  Field nth(uint64_t n) const {
+    size_t d = order();
+    if (n < d) {
+      return initial_[n];
+    }
+    if (d == 0) {
+      return Field(0);
+    }
+    if (d == 1) {
+      Field ans = initial_[0];
+      Field base = coefs_[0];
+      for (; n != 0; n >>= 1) {
+        if (n & 1) {
+          ans *= base;
+        }
+        base *= base;
+      }
+      return ans;
+    }
+
+    // x^n по модулю: слева направо, умножение на x - сдвиг с одним
+    // сносом старшего коэффициента
+    std::vector<Field> power(d, Field(0));
+    power[1] = Field(1);
+    int bit = 63;
+    while ((n >> bit & 1) == 0) {
+      --bit;
+    }
+    for (--bit; bit >= 0; --bit) {
+      power = my::detail::poly_mul_mod(power, power, coefs_);
+      if (n >> bit & 1) {
+        Field top = power[d - 1];
+        for (size_t i = d - 1; i > 0; --i) {
+          power[i] = power[i - 1] + top * coefs_[d - 1 - i];
+        }
+        power[0] = top * coefs_[d - 1];
+      }
+    }
+
+    Field ans(0);
+    for (size_t i = 0; i < d; ++i) {
+      ans += power[i] * initial_[i];
+    }
+    return ans;
+  }
+};
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "dynamic_matrix.h"
+#include "matrix.h"
+#include "recurrence.h"
+#include "thread_pool.h"
+
+// Разреженная матрица в формате CSR: ненулевые элементы строки i лежат в
+// values[offsets[i] .. offsets[i + 1]) по возрастанию столбцов columns.
+// CSC той же матрицы - это CSR транспонированной, поэтому отдельного
+// типа нет: transposed() и есть переход между форматами.
+template <typename Field = Rational>
+class SparseMatrix {
+ private:
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> columns_;
+  std::vector<Field> values_;
+
+  void check_vector(size_t size, const char* what) const {
+    if (size != cols_) {
+      throw std::invalid_argument(std::string(what) + ": size mismatch");
+    }
+  }
+
+ public:
+  using Triplet = std::tuple<size_t, size_t, Field>;
+
+  SparseMatrix() : offsets_(1, 0) {}
+
+  SparseMatrix(size_t rows, size_t cols)
+      : rows_(rows), cols_(cols), offsets_(rows + 1, 0) {}
+
+  // Элементы (строка, столбец, значение) в любом порядке; повторы
+  // складываются, нули отбрасываются.
+  SparseMatrix(size_t rows, size_t cols, std::vector<Triplet> triplets)
+      : SparseMatrix(rows, cols) {
+    std::sort(triplets.begin(), triplets.end(),
+              [](const Triplet& first, const Triplet& second) {
+                return std::tie(std::get<0>(first), std::get<1>(first)) <
+                       std::tie(std::get<0>(second), std::get<1>(second));
+              });
+
+    const Field zero(0);
+    for (size_t k = 0; k < triplets.size();) {
+      auto [i, j, value] = triplets[k];
+      if (i >= rows || j >= cols) {
+        throw std::out_of_range("SparseMatrix: index out of range");
+      }
+      for (++k; k < triplets.size() && std::get<0>(triplets[k]) == i &&
+                std::get<1>(triplets[k]) == j;
+           ++k) {
+        value += std::get<2>(triplets[k]);
+      }
+      if (value != zero) {
+        columns_.push_back(j);
+        values_.push_back(value);
+        ++offsets_[i + 1];
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      offsets_[i + 1] += offsets_[i];
+    }
+  }
+
+  explicit SparseMatrix(const DynamicMatrix<Field>& dense)
+      : SparseMatrix(dense.rows(), dense.cols()) {
+    const Field zero(0);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        if (dense[i][j] != zero) {
+          columns_.push_back(j);
+          values_.push_back(dense[i][j]);
+        }
+      }
+      offsets_[i + 1] = values_.size();
+    }
+  }
+
+  template <size_t N, size_t M>
+  explicit SparseMatrix(const Matrix<N, M, Field>& dense)
+      : SparseMatrix(DynamicMatrix<Field>(dense)) {}
+
+  static SparseMatrix unityMatrix(size_t n) {
+    SparseMatrix matrix(n, n);
+    for (size_t i = 0; i < n; ++i) {
+      matrix.columns_.push_back(i);
+      matrix.values_.push_back(Field(1));
+      matrix.offsets_[i + 1] = i + 1;
+    }
+    return matrix;
+  }
+
+  size_t rows() const {
+    return rows_;
+  }
+
+  size_t cols() const {
+    return cols_;
+  }
+
+  size_t nonZeros() const {
+    return values_.size();
+  }
+
+  const std::vector<size_t>& offsets() const {
+    return offsets_;
+  }
+
+  const std::vector<size_t>& columns() const {
+    return columns_;
+  }
+
+  const std::vector<Field>& values() const {
+    return values_;
+  }
+
+  Field at(size_t i, size_t j) const {
+    auto begin = columns_.begin() + offsets_[i];
+    auto end = columns_.begin() + offsets_[i + 1];
+    auto it = std::lower_bound(begin, end, j);
+    return it != end && *it == j ? values_[it - columns_.begin()] : Field(0);
+  }
+
+  bool operator==(const SparseMatrix& other) const {
+    return rows_ == other.rows_ && cols_ == other.cols_ &&
+           offsets_ == other.offsets_ && columns_ == other.columns_ &&
+           values_ == other.values_;
+  }
+
+  bool operator!=(const SparseMatrix& other) const {
+    return !(*this == other);
+  }
+
+  DynamicMatrix<Field> toDense() const {
+    DynamicMatrix<Field> dense(rows_, cols_);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+        dense[i][columns_[k]] = values_[k];
+      }
+    }
+    return dense;
+  }
+
+  template <size_t N, size_t M>
+  Matrix<N, M, Field> toMatrix() const {
+    if (rows_ != N || cols_ != M) {
+      throw std::invalid_argument("SparseMatrix::toMatrix: size mismatch");
+    }
+    Matrix<N, M, Field> dense;
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+        dense[i][columns_[k]] = values_[k];
+      }
+    }
+    return dense;
+  }
+
+  // Подсчётом по столбцам за O(nnz): строки результата сразу выходят
+  // упорядоченными по столбцам.
+  SparseMatrix transposed() const {
+    SparseMatrix ans(cols_, rows_);
+    for (size_t col : columns_) {
+      ++ans.offsets_[col + 1];
+    }
+    for (size_t j = 0; j < cols_; ++j) {
+      ans.offsets_[j + 1] += ans.offsets_[j];
+    }
+
+    ans.columns_.resize(nonZeros());
+    ans.values_.resize(nonZeros());
+    std::vector<size_t> next(ans.offsets_.begin(), ans.offsets_.end() - 1);
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+        size_t pos = next[columns_[k]]++;
+        ans.columns_[pos] = i;
+        ans.values_[pos] = values_[k];
+      }
+    }
+    return ans;
+  }
+
+  template <typename Policy = my::sequenced_policy>
+  std::vector<Field> multiply(const std::vector<Field>& vector,
+                              const Policy& policy = my::seq) const {
+    check_vector(vector.size(), "SparseMatrix::multiply");
+
+    std::vector<Field> ans(rows_, Field(0));
+    size_t per_row = nonZeros() / std::max<size_t>(1, rows_);
+    policy.parallel_for(
+        rows_, my::detail::row_grain(per_row), [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            Field sum(0);
+            for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+              sum += values_[k] * vector[columns_[k]];
+            }
+            ans[i] = sum;
+          }
+        });
+    return ans;
+  }
+
+  std::vector<Field> operator*(const std::vector<Field>& vector) const {
+    return multiply(vector);
+  }
+
+  // Густавсон: строка результата собирается в плотном аккумуляторе
+  // размера cols, а список занятых столбцов не даёт обходить его целиком.
+  SparseMatrix operator*(const SparseMatrix& other) const {
+    if (cols_ != other.rows_) {
+      throw std::invalid_argument("SparseMatrix::operator*: size mismatch");
+    }
+
+    const Field zero(0);
+    SparseMatrix ans(rows_, other.cols_);
+    std::vector<Field> accumulator(other.cols_, zero);
+    std::vector<bool> used(other.cols_, false);
+    std::vector<size_t> touched;
+
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+        size_t row = columns_[k];
+        for (size_t q = other.offsets_[row]; q < other.offsets_[row + 1];
+             ++q) {
+          size_t col = other.columns_[q];
+          if (!used[col]) {
+            used[col] = true;
+            touched.push_back(col);
+          }
+          accumulator[col] += values_[k] * other.values_[q];
+        }
+      }
+
+      std::sort(touched.begin(), touched.end());
+      for (size_t col : touched) {
+        if (accumulator[col] != zero) {
+          ans.columns_.push_back(col);
+          ans.values_.push_back(accumulator[col]);
+        }
+        accumulator[col] = zero;
+        used[col] = false;
+      }
+      touched.clear();
+      ans.offsets_[i + 1] = ans.values_.size();
+    }
+    return ans;
+  }
+
+  DynamicMatrix<Field> operator*(const DynamicMatrix<Field>& dense) const {
+    if (cols_ != dense.rows()) {
+      throw std::invalid_argument("SparseMatrix::operator*: size mismatch");
+    }
+
+    DynamicMatrix<Field> ans(rows_, dense.cols());
+    for (size_t i = 0; i < rows_; ++i) {
+      Field* dst = ans[i];
+      for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+        const Field* src = dense[columns_[k]];
+        const Field& value = values_[k];
+        for (size_t j = 0; j < dense.cols(); ++j) {
+          dst[j] += value * src[j];
+        }
+      }
+    }
+    return ans;
+  }
+};
+
+template <typename Field>
+std::ostream& operator<<(std::ostream& output,
+                         const SparseMatrix<Field>& matrix) {
+  return output << matrix.toDense();
+}
+
+namespace my {
+// Решение A x = b методом Видемана для квадратной невырожденной A над
+// конечным полем. Последовательность u^T A^i b, i < 2n, даёт (через
+// Берлекэмпа - Месси) многочлен P, для которого P(A) b = 0; если его
+// свободный член c != 0, то x = (P(A) - c) b / (c A). Нужны только
+// умножения A на вектор: O(n * nnz) вместо O(n^3) у исключения.
+//
+// Случайный u может дать делитель настоящего многочлена; тогда A x != b,
+// и попытка повторяется с другим u. После attempts неудач A считается
+// вырожденной: std::domain_error.
+template <typename Field, typename Policy = sequenced_policy>
+std::vector<Field> wiedemann_solve(const SparseMatrix<Field>& matrix,
+                                   const std::vector<Field>& b,
+                                   const Policy& policy = seq,
+                                   size_t attempts = 4) {
+  size_t n = matrix.rows();
+  if (matrix.cols() != n) {
+    throw std::invalid_argument("wiedemann_solve: matrix not square");
+  }
+  if (b.size() != n) {
+    throw std::invalid_argument("wiedemann_solve: size mismatch");
+  }
+
+  const Field zero(0);
+  if (std::all_of(b.begin(), b.end(),
+                  [&](const Field& elem) { return elem == zero; })) {
+    return std::vector<Field>(n, zero);
+  }
+
+  std::mt19937 gen(2024);
+  std::uniform_int_distribution<int> random_value(
+      1, std::numeric_limits<int>::max());
+
+  for (size_t attempt = 0; attempt < attempts; ++attempt) {
+    std::vector<Field> u(n);
+    for (auto& elem : u) {
+      elem = Field(random_value(gen));
+    }
+
+    std::vector<Field> terms(2 * n);
+    std::vector<Field> krylov = b;
+    for (size_t i = 0; i < 2 * n; ++i) {
+      Field dot(0);
+      for (size_t j = 0; j < n; ++j) {
+        dot += u[j] * krylov[j];
+      }
+      terms[i] = dot;
+      if (i + 1 < 2 * n) {
+        krylov = matrix.multiply(krylov, policy);
+      }
+    }
+
+    // a[k] = c[0] a[k - 1] + ... + c[d - 1] a[k - d], то есть
+    // P(z) = z^d - c[0] z^(d-1) - ... - c[d - 1]
+    auto recurrence = LinearRecurrence<Field>::fromTerms(terms);
+    const std::vector<Field>& coefs = recurrence.coefficients();
+    size_t d = coefs.size();
+    if (d == 0 || coefs[d - 1] == zero) {
+      continue;
+    }
+
+    // Горнер: x = (A^(d-1) b - c[0] A^(d-2) b - ... - c[d-2] b) / c[d-1]
+    std::vector<Field> x = b;
+    for (size_t i = 0; i + 1 < d; ++i) {
+      x = matrix.multiply(x, policy);
+      for (size_t j = 0; j < n; ++j) {
+        x[j] -= coefs[i] * b[j];
+      }
+    }
+    Field inverse = Field(1) / coefs[d - 1];
+    for (auto& elem : x) {
+      elem *= inverse;
+    }
+
+    if (matrix.multiply(x, policy) == b) {
+      return x;
+    }
+  }
+
+  throw std::domain_error("wiedemann_solve: singular matrix");
+}
+}  // namespace my
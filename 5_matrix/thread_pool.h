@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace my {
+// Та же функция есть в 4_geometry/parallel.h; макрос даёт включать оба
+// заголовка вместе, inline - в нескольких единицах трансляции.
+#ifndef MY_DEFAULT_THREADS
+#define MY_DEFAULT_THREADS
+inline size_t default_threads() {
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+#endif
+
+// Пул с постоянными потоками: parallel_for не создаёт потоки на каждый
+// вызов, что важно для исключения, где параллельный участок - на каждом
+// шаге. Куски [begin, end) раздаются через общий атомарный счётчик: поток,
+// закончивший раньше, сразу забирает следующий, так что неравные по
+// стоимости куски не оставляют ядра без дела.
+//
+// Вложенный parallel_for (из тела другого) выполняется последовательно в
+// вызвавшем потоке.
+class ThreadPool {
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::function<void()> job_;
+  size_t generation_ = 0;
+  size_t running_ = 0;
+  bool stop_ = false;
+  std::mutex call_mutex_;
+
+  static inline thread_local bool inside_ = false;
+
+  void loop() {
+    inside_ = true;
+    size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+      }
+      job_();
+      {
+        std::lock_guard lock(mutex_);
+        if (--running_ == 0) {
+          done_.notify_one();
+        }
+      }
+    }
+  }
+
+ public:
+  explicit ThreadPool(size_t threads = default_threads()) {
+    for (size_t i = 1; i < threads; ++i) {
+      workers_.emplace_back(&ThreadPool::loop, this);
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  // общий пул на все ядра
+  static ThreadPool& global() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  // вместе с вызывающим потоком
+  size_t size() const {
+    return workers_.size() + 1;
+  }
+
+  // Вызывает func(begin, end) для кусков [0, count) длины не больше grain.
+  template <typename Func>
+  void parallel_for(size_t count, size_t grain, Func func) {
+    grain = std::max<size_t>(1, grain);
+    if (count <= grain || workers_.empty() || inside_) {
+      for (size_t begin = 0; begin < count; begin += grain) {
+        func(begin, std::min(count, begin + grain));
+      }
+      return;
+    }
+
+    std::lock_guard call(call_mutex_);
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+      for (size_t begin = next.fetch_add(grain); begin < count;
+           begin = next.fetch_add(grain)) {
+        func(begin, std::min(count, begin + grain));
+      }
+    };
+
+    {
+      std::lock_guard lock(mutex_);
+      job_ = work;
+      running_ = workers_.size();
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    inside_ = true;
+    work();
+    inside_ = false;
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [&]() { return running_ == 0; });
+  }
+};
+
+// Политики выполнения для операций над матрицами: seq - в текущем потоке,
+// par - на пуле (по умолчанию общем), par.on(pool) - на заданном.
+struct sequenced_policy {
+  template <typename Func>
+  void parallel_for(size_t count, size_t grain, Func func) const {
+    grain = std::max<size_t>(1, grain);
+    for (size_t begin = 0; begin < count; begin += grain) {
+      func(begin, std::min(count, begin + grain));
+    }
+  }
+};
+
+struct parallel_policy {
+  ThreadPool* pool = nullptr;
+
+  parallel_policy on(ThreadPool& other) const {
+    return parallel_policy{&other};
+  }
+
+  template <typename Func>
+  void parallel_for(size_t count, size_t grain, Func func) const {
+    (pool != nullptr ? *pool : ThreadPool::global())
+        .parallel_for(count, grain, func);
+  }
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+}  // namespace my
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include "gemm.h"
+
+// Виды на данные матрицы без копирования: строка, столбец, подматрица и
+// транспонированная матрица. Вид хранит указатель и шаги, поэтому
+// транспонирование - это обмен шагов, а столбец - вектор с шагом строки.
+// T - Field для изменяемого вида и const Field для вида только на чтение.
+//
+// Вид не владеет данными и действителен, пока жива матрица.
+namespace my {
+template <typename T>
+class VectorView {
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t stride_ = 1;
+
+ public:
+  class iterator {
+   private:
+    T* ptr_ = nullptr;
+    size_t stride_ = 1;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    iterator() = default;
+
+    iterator(T* ptr, size_t stride) : ptr_(ptr), stride_(stride) {}
+
+    T& operator*() const {
+      return *ptr_;
+    }
+
+    iterator& operator++() {
+      ptr_ += stride_;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const iterator& other) const {
+      return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return ptr_ != other.ptr_;
+    }
+  };
+
+  VectorView() = default;
+
+  VectorView(T* data, size_t size, size_t stride = 1)
+      : data_(data), size_(size), stride_(stride) {}
+
+  operator VectorView<const T>() const {
+    return VectorView<const T>(data_, size_, stride_);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t stride() const {
+    return stride_;
+  }
+
+  T* data() const {
+    return data_;
+  }
+
+  T& operator[](size_t i) const {
+    return data_[i * stride_];
+  }
+
+  iterator begin() const {
+    return iterator(data_, stride_);
+  }
+
+  iterator end() const {
+    return iterator(data_ + size_ * stride_, stride_);
+  }
+};
+
+template <typename T>
+class MatrixView {
+ private:
+  T* data_ = nullptr;
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t row_stride_ = 0;
+  size_t col_stride_ = 1;
+
+ public:
+  using field_type = std::remove_const_t<T>;
+
+  MatrixView() = default;
+
+  MatrixView(T* data, size_t rows, size_t cols, size_t row_stride,
+             size_t col_stride = 1)
+      : data_(data),
+        rows_(rows),
+        cols_(cols),
+        row_stride_(row_stride),
+        col_stride_(col_stride) {}
+
+  operator MatrixView<const T>() const {
+    return MatrixView<const T>(data_, rows_, cols_, row_stride_,
+                               col_stride_);
+  }
+
+  size_t rows() const {
+    return rows_;
+  }
+
+  size_t cols() const {
+    return cols_;
+  }
+
+  size_t rowStride() const {
+    return row_stride_;
+  }
+
+  size_t colStride() const {
+    return col_stride_;
+  }
+
+  T* data() const {
+    return data_;
+  }
+
+  T& operator()(size_t i, size_t j) const {
+    return data_[i * row_stride_ + j * col_stride_];
+  }
+
+  VectorView<T> row(size_t i) const {
+    return VectorView<T>(data_ + i * row_stride_, cols_, col_stride_);
+  }
+
+  VectorView<T> column(size_t j) const {
+    return VectorView<T>(data_ + j * col_stride_, rows_, row_stride_);
+  }
+
+  VectorView<T> diagonal() const {
+    return VectorView<T>(data_, std::min(rows_, cols_),
+                         row_stride_ + col_stride_);
+  }
+
+  // rows x cols начиная с (row, col)
+  MatrixView block(size_t row, size_t col, size_t rows, size_t cols) const {
+    if (row + rows > rows_ || col + cols > cols_) {
+      throw std::out_of_range("MatrixView::block: out of range");
+    }
+    return MatrixView(data_ + row * row_stride_ + col * col_stride_, rows,
+                      cols, row_stride_, col_stride_);
+  }
+
+  MatrixView transposed() const {
+    return MatrixView(data_, cols_, rows_, col_stride_, row_stride_);
+  }
+
+  field_type trace() const {
+    field_type ans(0);
+    for (const auto& elem : diagonal()) {
+      ans += elem;
+    }
+    return ans;
+  }
+};
+
+// C = A * B по видам: любые шаги, в том числе транспонированные виды,
+// без копирования операндов.
+template <typename Policy, typename First, typename Second, typename Field>
+  requires std::same_as<std::remove_const_t<First>, Field> &&
+           std::same_as<std::remove_const_t<Second>, Field>
+void gemm(const Policy& policy, MatrixView<First> a, MatrixView<Second> b,
+          MatrixView<Field> c) {
+  if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols()) {
+    throw std::invalid_argument("gemm: size mismatch");
+  }
+  for (size_t i = 0; i < c.rows(); ++i) {
+    for (auto& elem : c.row(i)) {
+      elem = Field(0);
+    }
+  }
+  detail::gemm_update<false>(policy, a.rows(), a.cols(), b.cols(), a.data(),
+                             a.rowStride(), a.colStride(), b.data(),
+                             b.rowStride(), b.colStride(), c.data(),
+                             c.rowStride(), c.colStride());
+}
+
+// C -= A * B по видам
+template <typename Policy, typename First, typename Second, typename Field>
+  requires std::same_as<std::remove_const_t<First>, Field> &&
+           std::same_as<std::remove_const_t<Second>, Field>
+void gemm_subtract(const Policy& policy, MatrixView<First> a,
+                   MatrixView<Second> b, MatrixView<Field> c) {
+  if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols()) {
+    throw std::invalid_argument("gemm_subtract: size mismatch");
+  }
+  detail::gemm_update<true>(policy, a.rows(), a.cols(), b.cols(), a.data(),
+                            a.rowStride(), a.colStride(), b.data(),
+                            b.rowStride(), b.colStride(), c.data(),
+                            c.rowStride(), c.colStride());
+}
+}  // namespace my